@@ -56,6 +56,28 @@ else ()
 	endforeach()
 endif()
 
+# Arrays of strings and alarms were added to f142 later, check whether the
+# schema has them.
+if (CONAN_INCLUDE_DIRS_STREAMING-DATA-TYPES)
+	file(GLOB_RECURSE f142_schema "${CONAN_INCLUDE_DIRS_STREAMING-DATA-TYPES}/f142_logdata_generated.h")
+else ()
+	set(f142_schema "${path_include_streaming_data_types}/schemas/f142_logdata.fbs")
+endif()
+set(STREAMING_DATA_TYPES_F142_ARRAY_STRING FALSE)
+set(STREAMING_DATA_TYPES_F142_ALARM FALSE)
+if (f142_schema)
+	file(STRINGS ${f142_schema} f142_array_string REGEX "ArrayString")
+	if (f142_array_string)
+		set(STREAMING_DATA_TYPES_F142_ARRAY_STRING TRUE)
+	endif()
+	file(STRINGS ${f142_schema} f142_alarm REGEX "AlarmSeverity")
+	if (f142_alarm)
+		set(STREAMING_DATA_TYPES_F142_ALARM TRUE)
+	endif()
+endif()
+message(STATUS "f142 supports arrays of strings: ${STREAMING_DATA_TYPES_F142_ARRAY_STRING}")
+message(STATUS "f142 supports alarms: ${STREAMING_DATA_TYPES_F142_ALARM}")
+
 add_custom_target(flatbuffers_generate ALL DEPENDS ${flatbuffers_generated_headers})
 if (DEFINED check_streaming_data_types)
 	add_dependencies(flatbuffers_generate check_streaming_data_types)
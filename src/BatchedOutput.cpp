@@ -0,0 +1,29 @@
+#include "BatchedOutput.h"
+
+namespace Forwarder {
+
+BatchedOutput::BatchedOutput(std::unique_ptr<FlatBufs::MessageBatch> Batch,
+                             std::unique_ptr<KafkaOutput> Output)
+    : Batch(std::move(Batch)), Output(std::move(Output)) {}
+
+BatchedOutput::~BatchedOutput() { flush(true); }
+
+void BatchedOutput::emit(
+    std::unique_ptr<FlatBufs::FlatbufferMessage> Message) {
+  std::lock_guard<std::mutex> Lock(Mutex);
+  auto Complete = Batch->add(std::move(Message));
+  if (Complete != nullptr) {
+    Output->emit(std::move(Complete));
+  }
+}
+
+int BatchedOutput::flush(bool Force) {
+  std::lock_guard<std::mutex> Lock(Mutex);
+  auto Due = Force ? Batch->take() : Batch->takeIfDue();
+  if (Due == nullptr) {
+    return 0;
+  }
+  Output->emit(std::move(Due));
+  return 1;
+}
+} // namespace Forwarder
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "BatchingFlatBufferCreator.h"
+#include "KafkaOutput.h"
+#include <memory>
+#include <mutex>
+
+namespace Forwarder {
+
+/// Kafka output shared by all conversion paths of a converter to one topic,
+/// whose messages are packed into batches.
+///
+/// All batches go through the same KafkaOutput and therefore with the same
+/// key to the same partition, so the updates of every channel stay in order.
+class BatchedOutput {
+public:
+  BatchedOutput(std::unique_ptr<FlatBufs::MessageBatch> Batch,
+                std::unique_ptr<KafkaOutput> Output);
+  /// Sends the pending batch.
+  ~BatchedOutput();
+  /// Adds the message to the batch and sends the batch if it is complete.
+  void emit(std::unique_ptr<FlatBufs::FlatbufferMessage> Message);
+  /// Sends the batch.
+  ///
+  /// \param Force Send the batch even if its deadline has not passed yet.
+  /// \return 1 if a batch was sent, 0 otherwise.
+  int flush(bool Force);
+  KafkaOutput &getOutput() const { return *Output; }
+
+private:
+  /// Keeps the batches in order, they are handed to the KafkaOutput while
+  /// holding it.
+  std::mutex Mutex;
+  std::unique_ptr<FlatBufs::MessageBatch> Batch;
+  std::unique_ptr<KafkaOutput> Output;
+};
+} // namespace Forwarder
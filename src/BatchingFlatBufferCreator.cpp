@@ -0,0 +1,101 @@
+#include "BatchingFlatBufferCreator.h"
+#include "helper.h"
+#include "logger.h"
+#include <cstring>
+#include <string>
+
+namespace FlatBufs {
+
+static size_t const BatchHeaderSize = 8;
+static size_t const EntryHeaderSize = 8;
+
+FlatbufferMessageSlice BatchMessage::message() {
+  return {Data.data(), Data.size()};
+}
+
+MessageBatch::MessageBatch(size_t MaxBytes, std::chrono::milliseconds MaxDelay,
+                           std::shared_ptr<BatchCounters> Counters)
+    : MaxBytes(MaxBytes), MaxDelay(MaxDelay), Counters(std::move(Counters)) {}
+
+std::unique_ptr<FlatbufferMessage>
+MessageBatch::add(std::unique_ptr<FlatbufferMessage> Message) {
+  auto Slice = Message->message();
+  auto Size = static_cast<uint32_t>(Slice.size);
+  auto Padding = (8 - Size % 8) % 8;
+  if (!Batch) {
+    Batch = ::make_unique<BatchMessage>();
+    Batch->Data.reserve(MaxBytes + BatchHeaderSize + EntryHeaderSize + Size +
+                        Padding);
+    Batch->Data.resize(BatchHeaderSize);
+    std::memcpy(Batch->Data.data() + 4, BatchIdentifier, 4);
+    NumEntries = 0;
+    BatchStart = std::chrono::steady_clock::now();
+  }
+  auto &Data = Batch->Data;
+  auto Offset = Data.size();
+  Data.resize(Offset + EntryHeaderSize + Size + Padding);
+  std::memcpy(Data.data() + Offset, &Size, sizeof(Size));
+  std::memcpy(Data.data() + Offset + EntryHeaderSize, Slice.data, Size);
+  ++NumEntries;
+  ++Counters->NumEntries;
+  // The flatbuffer is copied, hand the message back right away
+  Message.release()->release();
+  if (Data.size() >= MaxBytes) {
+    return take();
+  }
+  return takeIfDue();
+}
+
+std::unique_ptr<FlatbufferMessage> MessageBatch::takeIfDue() {
+  if (Batch && std::chrono::steady_clock::now() - BatchStart >= MaxDelay) {
+    return take();
+  }
+  return nullptr;
+}
+
+std::unique_ptr<FlatbufferMessage> MessageBatch::take() {
+  if (!Batch) {
+    return nullptr;
+  }
+  std::memcpy(Batch->Data.data(), &NumEntries, sizeof(NumEntries));
+  ++Counters->NumBatches;
+  return std::move(Batch);
+}
+
+BatchingFlatBufferCreator::BatchingFlatBufferCreator(
+    std::unique_ptr<FlatBufferCreator> Inner)
+    : Inner(std::move(Inner)) {}
+
+std::unique_ptr<FlatbufferMessage>
+BatchingFlatBufferCreator::create(EpicsPVUpdate const &up) {
+  return Inner->create(up);
+}
+
+std::unique_ptr<MessageBatch> BatchingFlatBufferCreator::createBatch() {
+  return ::make_unique<MessageBatch>(MaxBatchBytes, MaxBatchDelay, Counters);
+}
+
+void BatchingFlatBufferCreator::config(
+    std::map<std::string, std::string> const &Config) {
+  try {
+    auto It = Config.find("batch_bytes");
+    if (It != Config.end()) {
+      MaxBatchBytes = std::stoul(It->second);
+    }
+    It = Config.find("batch_ms");
+    if (It != Config.end()) {
+      MaxBatchDelay = std::chrono::milliseconds(std::stoul(It->second));
+    }
+  } catch (std::logic_error &) {
+    LOG(Sev::Warning, "Invalid batch setting, keeping the defaults");
+  }
+  Inner->config(Config);
+}
+
+std::map<std::string, double> BatchingFlatBufferCreator::getStats() {
+  auto Stats = Inner->getStats();
+  Stats["batches"] = Counters->NumBatches;
+  Stats["batch_entries"] = Counters->NumEntries;
+  return Stats;
+}
+} // namespace FlatBufs
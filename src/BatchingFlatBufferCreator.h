@@ -0,0 +1,90 @@
+#pragma once
+
+#include "FlatBufferCreator.h"
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+namespace FlatBufs {
+
+/// Tells batches apart from plain flatbuffers on the same topic.
+constexpr char BatchIdentifier[] = "fbat";
+
+/// Kafka message which carries a batch of flatbuffers.
+///
+/// The message itself is not a flatbuffer.  It starts with an 8 byte header:
+/// the little endian number of entries in the first 4 bytes, followed by
+/// BatchIdentifier where a flatbuffer has its file identifier.  Each entry
+/// starts with an 8 byte header whose first 4 bytes hold the little endian
+/// size of the flatbuffer which follows, the other 4 bytes are zero.  Entries
+/// are padded to 8 bytes so that every flatbuffer is aligned.
+class BatchMessage : public FlatbufferMessage {
+public:
+  FlatbufferMessageSlice message() override;
+  std::vector<uint8_t> Data;
+};
+
+/// Counters shared by all batches of a creator.
+struct BatchCounters {
+  std::atomic<uint64_t> NumBatches{0};
+  std::atomic<uint64_t> NumEntries{0};
+};
+
+/// Collects flatbuffers into one Kafka message.
+///
+/// Not thread safe, the owner has to serialize the calls.
+class MessageBatch {
+public:
+  MessageBatch(size_t MaxBytes, std::chrono::milliseconds MaxDelay,
+               std::shared_ptr<BatchCounters> Counters);
+
+  /// Copies the flatbuffer into the batch and releases the message.
+  ///
+  /// \return The batch if it is full or overdue now, nullptr otherwise.
+  std::unique_ptr<FlatbufferMessage>
+  add(std::unique_ptr<FlatbufferMessage> Message);
+
+  /// \return The batch if its first entry is older than the maximum delay,
+  /// nullptr otherwise.
+  std::unique_ptr<FlatbufferMessage> takeIfDue();
+
+  /// \return The batch regardless of its age, nullptr if it is empty.
+  std::unique_ptr<FlatbufferMessage> take();
+
+private:
+  size_t MaxBytes;
+  std::chrono::milliseconds MaxDelay;
+  std::shared_ptr<BatchCounters> Counters;
+  std::unique_ptr<BatchMessage> Batch;
+  uint32_t NumEntries = 0;
+  std::chrono::steady_clock::time_point BatchStart;
+};
+
+/// Lets the conversion paths of another creator pack its flatbuffers into
+/// batches to save the per message overhead of Kafka.
+///
+/// create() passes the flatbuffers of the wrapped creator through.  All
+/// conversion paths of a converter to the same topic share one MessageBatch
+/// from createBatch(), so a batch holds the updates of many channels.
+class BatchingFlatBufferCreator : public FlatBufferCreator {
+public:
+  explicit BatchingFlatBufferCreator(std::unique_ptr<FlatBufferCreator> Inner);
+
+  std::unique_ptr<FlatbufferMessage> create(EpicsPVUpdate const &up) override;
+
+  std::unique_ptr<MessageBatch> createBatch() override;
+
+  /// Accepts "batch_bytes" and "batch_ms", everything is passed on to the
+  /// wrapped creator as well.
+  void config(std::map<std::string, std::string> const &Config) override;
+
+  std::map<std::string, double> getStats() override;
+
+private:
+  std::unique_ptr<FlatBufferCreator> Inner;
+  size_t MaxBatchBytes = 64 * 1024;
+  std::chrono::milliseconds MaxBatchDelay{100};
+  std::shared_ptr<BatchCounters> Counters = std::make_shared<BatchCounters>();
+};
+} // namespace FlatBufs
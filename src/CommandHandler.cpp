@@ -12,7 +12,7 @@ ConfigCB::ConfigCB(Forwarder &main) : main(main) {}
 void ConfigCB::operator()(std::string const &msg) {
   LOG(Sev::Debug, "Command received: {}", msg);
   try {
-    handleCommand(msg);
+    handleCommand(nlohmann::json::parse(msg));
   } catch (nlohmann::json::parse_error const &e) {
     LOG(Sev::Error,
         "Could not parse command. Command was {}. Exception was: {}", msg,
@@ -24,33 +24,36 @@ void ConfigCB::operator()(std::string const &msg) {
 
 void ConfigCB::handleCommandAdd(nlohmann::json const &Document) {
   // Use instance of ConfigParser to extract stream info.
-  ConfigParser Config(Document.dump());
+  ConfigParser Config(Document);
   auto Settings = Config.extractStreamInfo();
 
-  for (auto &Stream : Settings.StreamsInfo) {
-    main.addMapping(Stream);
-  }
+  main.addMappings(Settings.StreamsInfo);
+}
+
+void ConfigCB::handleCommandSet(nlohmann::json const &Document) {
+  ConfigParser Config(Document);
+  auto Settings = Config.extractStreamInfo();
+
+  main.setMappings(Settings.StreamsInfo);
 }
 
 void ConfigCB::handleCommandStopChannel(nlohmann::json const &Document) {
   if (auto ChannelMaybe = find<std::string>("channel", Document)) {
-    main.streams.stopChannel(ChannelMaybe.inner());
+    main.stopChannel(ChannelMaybe.inner());
   }
 }
 
-void ConfigCB::handleCommandStopAll() { main.streams.clearStreams(); }
+void ConfigCB::handleCommandStopAll() { main.stopAllChannels(); }
 
 void ConfigCB::handleCommandExit() { main.stopForwarding(); }
 
-void ConfigCB::handleCommand(std::string const &Msg) {
-  using nlohmann::json;
-  LOG(Sev::Error, "Msg is {}", Msg);
-  auto Document = json::parse(Msg);
-
+void ConfigCB::handleCommand(nlohmann::json const &Document) {
   std::string Command = findCommand(Document);
 
   if (Command == "add") {
     handleCommandAdd(Document);
+  } else if (Command == "set") {
+    handleCommandSet(Document);
   } else if (Command == "stop_channel") {
     handleCommandStopChannel(Document);
   } else if (Command == "stop_all") {
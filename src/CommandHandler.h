@@ -27,8 +27,9 @@ public:
 
 private:
   Forwarder &main;
-  void handleCommand(std::string const &Msg);
+  void handleCommand(nlohmann::json const &Document);
   void handleCommandAdd(nlohmann::json const &Document);
+  void handleCommandSet(nlohmann::json const &Document);
   void handleCommandStopChannel(nlohmann::json const &Document);
   void handleCommandStopAll();
   void handleCommandExit();
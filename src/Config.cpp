@@ -20,8 +20,11 @@ Listener::Listener(URI uri,
 }
 
 void Listener::poll(::Forwarder::ConfigCB &cb) {
-  auto Message = Consumer->poll();
-  if (Message->getStatus() == KafkaW::PollStatus::Message) {
+  for (size_t i = 0; i < MaxMessagesPerPoll; ++i) {
+    auto Message = Consumer->poll();
+    if (Message->getStatus() != KafkaW::PollStatus::Message) {
+      break;
+    }
     cb(Message->getData());
   }
 }
@@ -22,7 +22,10 @@ public:
   Listener(URI uri, std::unique_ptr<KafkaW::ConsumerInterface> NewConsumer);
   Listener(Listener const &) = delete;
   ~Listener() = default;
+  /// Hands all pending commands to the callback, at most
+  /// MaxMessagesPerPoll of them.
   void poll(::Forwarder::ConfigCB &cb);
+  static size_t const MaxMessagesPerPoll = 1000;
 
 private:
   std::unique_ptr<KafkaW::ConsumerInterface> Consumer;
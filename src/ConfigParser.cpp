@@ -29,6 +29,9 @@ static std::vector<std::string> split(const std::string &Brokers) {
 ConfigParser::ConfigParser(const std::string &RawJson)
     : Json(nlohmann::json::parse(RawJson)) {}
 
+ConfigParser::ConfigParser(nlohmann::json Document)
+    : Json(std::move(Document)) {}
+
 ConfigSettings ConfigParser::extractStreamInfo() {
   ConfigSettings Settings{};
   using nlohmann::json;
@@ -40,6 +43,23 @@ ConfigSettings ConfigParser::extractStreamInfo() {
         // Find the basic information
         extractMappingInfo(StreamJson, Stream.Name, Stream.EpicsProtocol);
 
+        if (auto x = find<bool>("zero_copy", StreamJson)) {
+          Stream.ZeroCopy = x.inner();
+        }
+
+        if (auto x = find<size_t>("queue_size", StreamJson)) {
+          Stream.QueueSize = x.inner();
+        }
+        if (auto x = find<std::string>("overflow_policy", StreamJson)) {
+          Stream.Overflow = extractOverflowPolicy(x.inner());
+        }
+        if (auto x = find<bool>("coalesce", StreamJson)) {
+          Stream.Coalesce = x.inner();
+        }
+        if (auto x = find<nlohmann::json>("filter", StreamJson)) {
+          Stream.Filter = extractFilterSettings(x.inner());
+        }
+
         // Find the converters, if present
         if (auto x = find<nlohmann::json>("converter", StreamJson)) {
           if (x.inner().is_object()) {
@@ -114,7 +134,56 @@ ConfigParser::extractConverterSettings(nlohmann::json const &Mapping) {
     Settings.Name = fmt::format("converter_{}", ConverterIndex++);
   }
 
+  if (auto x = find<nlohmann::json>("config", Mapping)) {
+    Settings.Config = extractStringMap(x.inner(), "Converter config");
+  }
+
+  if (auto x = find<nlohmann::json>("kafka", Mapping)) {
+    Settings.Kafka = extractStringMap(x.inner(), "Converter kafka settings");
+  }
+
   return Settings;
 }
 
+std::map<std::string, std::string>
+ConfigParser::extractStringMap(nlohmann::json const &Object,
+                               std::string const &What) {
+  if (!Object.is_object()) {
+    throw MappingAddException(fmt::format("{} is not a JSON object", What));
+  }
+  std::map<std::string, std::string> Map;
+  for (auto It = Object.begin(); It != Object.end(); ++It) {
+    Map[It.key()] = It.value().is_string() ? It.value().get<std::string>()
+                                           : It.value().dump();
+  }
+  return Map;
+}
+
+OverflowPolicy ConfigParser::extractOverflowPolicy(std::string const &Name) {
+  if (Name == "drop_oldest") {
+    return OverflowPolicy::DropOldest;
+  }
+  if (Name == "drop_newest") {
+    return OverflowPolicy::DropNewest;
+  }
+  if (Name == "block") {
+    return OverflowPolicy::Block;
+  }
+  throw MappingAddException(fmt::format("Unknown overflow_policy: {}", Name));
+}
+
+FilterSettings
+ConfigParser::extractFilterSettings(nlohmann::json const &Filter) {
+  FilterSettings Settings;
+  if (auto x = find<double>("deadband_absolute", Filter)) {
+    Settings.DeadbandAbsolute = x.inner();
+  }
+  if (auto x = find<double>("deadband_relative", Filter)) {
+    Settings.DeadbandRelative = x.inner();
+  }
+  if (auto x = find<uint64_t>("min_interval_ms", Filter)) {
+    Settings.MinIntervalMS = x.inner();
+  }
+  return Settings;
+}
 } // namespace Forwarder
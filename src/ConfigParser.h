@@ -1,5 +1,6 @@
 #pragma once
 
+#include "OverflowPolicy.h"
 #include "URI.h"
 #include <atomic>
 #include <deque>
@@ -15,6 +16,20 @@ struct ConverterSettings {
   std::string Schema;
   std::string Topic;
   std::string Name;
+  /// Schema specific settings, passed on to the converter.
+  std::map<std::string, std::string> Config;
+  /// librdkafka properties for the topic of this converter.
+  std::map<std::string, std::string> Kafka;
+};
+
+/// Holder for the filter settings of a stream, zero disables a criterion.
+struct FilterSettings {
+  /// Minimum absolute change of a numeric value.
+  double DeadbandAbsolute{0};
+  /// Minimum change of a numeric value relative to the last forwarded one.
+  double DeadbandRelative{0};
+  /// Minimum time between two forwarded updates.
+  uint64_t MinIntervalMS{0};
 };
 
 /// Holder for the stream settings defined in the streams configuration file.
@@ -22,6 +37,16 @@ struct StreamSettings {
   std::string Name;
   std::string EpicsProtocol;
   std::vector<ConverterSettings> Converters;
+  /// Convert straight from the EPICS monitor element instead of a copy.
+  bool ZeroCopy{false};
+  /// Maximum number of queued PV updates, 0 for unbounded.
+  size_t QueueSize{0};
+  /// What to do with PV updates when the queue is full.
+  OverflowPolicy Overflow{OverflowPolicy::DropOldest};
+  /// Only forward the latest PV update instead of queueing all of them.
+  bool Coalesce{false};
+  /// Drops updates before they are converted.
+  FilterSettings Filter;
 };
 
 /// Holder for the configuration settings defined in the configuration file.
@@ -30,6 +55,7 @@ struct ConfigSettings {
   std::vector<URI> Brokers;
   size_t ConversionThreads{1};
   size_t ConversionWorkerQueueSize{1024};
+  size_t ProducersPerBroker{1};
   int32_t MainPollInterval{500};
   URI StatusReportURI;
   std::map<std::string, std::string> KafkaConfiguration;
@@ -45,6 +71,11 @@ public:
   /// \param RawJson The JSON to be parsed.
   explicit ConfigParser(const std::string &RawJson);
 
+  /// Constructor
+  ///
+  /// \param Document The JSON which was already parsed.
+  explicit ConfigParser(nlohmann::json Document);
+
   /// Extract the configuration information from the JSON.
   ///
   /// \return The extracted settings.
@@ -61,6 +92,10 @@ private:
   static void extractMappingInfo(nlohmann::json const &Mapping,
                                  std::string &Channel, std::string &Protocol);
   ConverterSettings extractConverterSettings(nlohmann::json const &Mapping);
+  static OverflowPolicy extractOverflowPolicy(std::string const &Name);
+  static FilterSettings extractFilterSettings(nlohmann::json const &Filter);
+  static std::map<std::string, std::string>
+  extractStringMap(nlohmann::json const &Object, std::string const &What);
   std::atomic<uint32_t> ConverterIndex{0};
 };
 } // namespace Forwarder
@@ -1,17 +1,83 @@
 #include "ConversionWorker.h"
-#include "Forwarder.h"
+#include "Streams.h"
 #include "logger.h"
+#include <algorithm>
 #include <chrono>
-#include <thread>
 
 namespace Forwarder {
 
-ConversionWorkPacket::~ConversionWorkPacket() {
-  if (stream) {
-    cp->transit--;
+ConversionWorkQueue::ConversionWorkQueue(size_t Capacity) {
+  for (size_t i = 0; i < Capacity; ++i) {
+    auto Packet = new ConversionWorkPacket;
+    ++NumAllocations;
+    Packet->Next = Free;
+    Free = Packet;
   }
 }
 
+ConversionWorkQueue::~ConversionWorkQueue() {
+  while (auto Packet = pop()) {
+    release(Packet);
+  }
+  while (Free != nullptr) {
+    auto Packet = Free;
+    Free = Free->Next;
+    delete Packet;
+  }
+}
+
+ConversionWorkPacket *ConversionWorkQueue::acquire() {
+  if (Free == nullptr) {
+    ++NumAllocations;
+    return new ConversionWorkPacket;
+  }
+  auto Packet = Free;
+  Free = Free->Next;
+  Packet->Next = nullptr;
+  return Packet;
+}
+
+void ConversionWorkQueue::push(ConversionWorkPacket *Packet) {
+  Packet->Next = nullptr;
+  if (Tail == nullptr) {
+    Head = Packet;
+  } else {
+    Tail->Next = Packet;
+  }
+  Tail = Packet;
+  ++Size;
+}
+
+ConversionWorkPacket *ConversionWorkQueue::pop() {
+  auto Packet = Head;
+  if (Packet == nullptr) {
+    return nullptr;
+  }
+  Head = Packet->Next;
+  if (Head == nullptr) {
+    Tail = nullptr;
+  }
+  --Size;
+  return Packet;
+}
+
+void ConversionWorkQueue::release(ConversionWorkPacket *Packet) {
+  if (Packet->stream) {
+    Packet->cp->transit--;
+  }
+  Packet->up.reset();
+  Packet->cp = nullptr;
+  Packet->stream = nullptr;
+  Packet->Next = Free;
+  Free = Packet;
+}
+
+ConversionWorker::ConversionWorker(ConversionScheduler *scheduler,
+                                   uint32_t queue_size)
+    : queue(queue_size), QueueSize(queue_size), scheduler(scheduler) {
+  Cursor.WorkerID = scheduler->addWorker();
+}
+
 int ConversionWorker::start() {
   do_run = 1;
   thr = std::thread([this] { run(); });
@@ -20,70 +86,84 @@ int ConversionWorker::start() {
 
 int ConversionWorker::stop() {
   do_run = 0;
+  scheduler->getWorkSignal()->notifyAll();
   if (thr.joinable())
     thr.join();
   return 0;
 }
 
 int ConversionWorker::run() {
-  using CLK = std::chrono::steady_clock;
-  using MS = std::chrono::milliseconds;
-  auto Dt = MS(100);
-  auto t1 = CLK::now();
+  // Only a safety net, workers are woken up as soon as updates are queued.
+  auto IdleTimeout = std::chrono::milliseconds(100);
+  auto Signal = scheduler->getWorkSignal();
   while (do_run) {
-    auto qs = queue.size_approx();
-    if (qs == 0) {
-      auto qf = queue.MAX_SUBQUEUE_SIZE - qs;
-      scheduler->fill(queue, qf, id);
+    auto Ticket = Signal->prepareWait();
+    if (queue.size() == 0) {
+      scheduler->fill(queue, QueueSize, Cursor);
     }
-    while (true) {
-      std::unique_ptr<ConversionWorkPacket> p;
-      bool found = queue.try_dequeue(p);
-      if (!found)
-        break;
-      auto cwp = std::move(p);
+    uint32_t NumConverted = 0;
+    while (auto cwp = queue.pop()) {
       cwp->cp->emit(std::move(cwp->up));
+      queue.release(cwp);
+      ++NumConverted;
     }
-    auto t2 = CLK::now();
-    auto dt = std::chrono::duration_cast<MS>(t2 - t1);
-    if (dt < Dt) {
-      std::this_thread::sleep_for(Dt - dt);
+    if (NumConverted == 0) {
+      Signal->wait(Ticket, IdleTimeout);
     }
-    t1 = t2;
   }
   return 0;
 }
 
-std::atomic<uint32_t> ConversionWorker::s_id{0};
+ConversionScheduler::ConversionScheduler(Streams &streams)
+    : streams(streams), Signal(std::make_shared<WorkSignal>()) {}
 
-ConversionScheduler::ConversionScheduler(Forwarder *main) : main(main) {}
+std::shared_ptr<WorkSignal> ConversionScheduler::getWorkSignal() const {
+  return Signal;
+}
+
+uint32_t ConversionScheduler::addWorker() { return NumWorkers++; }
 
-int ConversionScheduler::fill(
-    moodycamel::ConcurrentQueue<std::unique_ptr<ConversionWorkPacket>> &queue,
-    uint32_t const nfm, uint32_t wid) {
-  std::lock_guard<std::mutex> lock(mx);
-  if (main->streams.size() == 0) {
+int ConversionScheduler::fill(ConversionWorkQueue &queue, uint32_t const nfm,
+                              SchedulerCursor &Cursor) {
+  Cursor.Streams = streams.getStreamsSnapshot();
+  auto const &StreamList = *Cursor.Streams;
+  size_t NumStreams = StreamList.size();
+  if (NumStreams == 0) {
     return 0;
   }
-  auto lock_streams = main->get_lock_streams();
+  size_t const Stride = std::max(NumWorkers.load(), 1u);
+  size_t const Wid = Cursor.WorkerID;
   uint32_t nfc = 0;
-  if (sid >= main->streams.size()) {
-    sid = 0;
-  }
-  auto sid0 = sid;
-  while (nfc < nfm) {
-    auto n1 = main->streams[sid]->fillConversionQueue(queue, nfm - nfc);
+
+  // Own shard: stream indices Wid, Wid + Stride, Wid + 2 * Stride, ...
+  size_t NumOwned = NumStreams > Wid ? (NumStreams - Wid - 1) / Stride + 1 : 0;
+  for (size_t i = 0; i < NumOwned && nfc < nfm; ++i) {
+    size_t Sid = Wid + (Cursor.Own % NumOwned) * Stride;
+    Cursor.Own = (Cursor.Own + 1) % NumOwned;
+    auto n1 = StreamList[Sid]->fillConversionQueue(queue, nfm - nfc);
     if (n1 > 0) {
-      LOG(Sev::Debug, "Give worker {:2}  items: {:3}  stream: {:3}", wid, n1,
-          sid);
+      LOG(Sev::Debug, "Give worker {:2}  items: {:3}  stream: {:3}", Wid, n1,
+          Sid);
     }
     nfc += n1;
-    sid += 1;
-    if (sid >= main->streams.size()) {
-      sid = 0;
+  }
+  if (nfc > 0 || Stride == 1) {
+    return nfc;
+  }
+
+  // Nothing to do in the own shard, help out with the others.
+  for (size_t i = 0; i < NumStreams && nfc < nfm; ++i) {
+    size_t Sid = Cursor.Steal % NumStreams;
+    Cursor.Steal = (Cursor.Steal + 1) % NumStreams;
+    if (Sid % Stride == Wid) {
+      continue;
     }
-    if (sid == sid0)
-      break;
+    auto n1 = StreamList[Sid]->fillConversionQueue(queue, nfm - nfc);
+    if (n1 > 0) {
+      LOG(Sev::Debug, "Worker {:2} steals  items: {:3}  stream: {:3}", Wid, n1,
+          Sid);
+    }
+    nfc += n1;
   }
   return nfc;
 }
@@ -2,53 +2,125 @@
 #include "EpicsPVUpdate.h"
 #include "RangeSet.h"
 #include "Stream.h"
+#include "WorkSignal.h"
 #include <atomic>
-#include <concurrentqueue/concurrentqueue.h>
-#include <mutex>
+#include <memory>
 #include <thread>
+#include <vector>
 
 namespace Forwarder {
 
-class Forwarder;
 class ConversionScheduler;
 class ConversionPath;
 class Stream;
+class Streams;
 
 struct ConversionWorkPacket {
-  ~ConversionWorkPacket();
   std::shared_ptr<FlatBufs::EpicsPVUpdate> up;
   ConversionPath *cp = nullptr;
+  /// Only set on the last packet of a refill for each conversion path.
   Stream *stream = nullptr;
+  /// Intrusive link, used by ConversionWorkQueue.
+  ConversionWorkPacket *Next = nullptr;
+};
+
+/// FIFO of work packets of a single conversion worker, together with the pool
+/// which the packets are recycled to.
+///
+/// Refill and conversion both happen on the worker thread, so neither needs
+/// any synchronization.  Once warmed up, forwarding an update does not
+/// allocate.
+class ConversionWorkQueue {
+public:
+  /// \param Capacity Number of packets to preallocate.
+  explicit ConversionWorkQueue(size_t Capacity = 0);
+  ConversionWorkQueue(ConversionWorkQueue const &) = delete;
+  ConversionWorkQueue &operator=(ConversionWorkQueue const &) = delete;
+  ~ConversionWorkQueue();
+
+  /// Takes an unused packet from the pool, allocates if the pool is empty.
+  ConversionWorkPacket *acquire();
+
+  /// Appends a packet to the queue.
+  void push(ConversionWorkPacket *Packet);
+
+  /// Takes the oldest packet from the queue.
+  ///
+  /// \return The packet or nullptr if the queue is empty.
+  ConversionWorkPacket *pop();
+
+  /// Returns a packet to the pool after it was converted.
+  ///
+  /// Releases the PV update and decrements the transit counter of the
+  /// conversion path if this was the last packet of a refill.
+  void release(ConversionWorkPacket *Packet);
+
+  size_t size() const { return Size; }
+
+  /// \return The number of packets allocated so far.
+  uint64_t getNumAllocations() const { return NumAllocations; }
+
+private:
+  ConversionWorkPacket *Head = nullptr;
+  ConversionWorkPacket *Tail = nullptr;
+  ConversionWorkPacket *Free = nullptr;
+  size_t Size = 0;
+  uint64_t NumAllocations = 0;
+};
+
+/// Where a conversion worker continues to look for work on its next refill.
+struct SchedulerCursor {
+  uint32_t WorkerID = 0;
+  /// Next position in the shard of streams owned by the worker.
+  size_t Own = 0;
+  /// Next position to steal from when the own shard is empty.
+  size_t Steal = 0;
+  /// The stream list used for the last refill.  Kept until the next refill so
+  /// that a removed stream is never destroyed by the worker while it still
+  /// holds work packets for it.
+  std::shared_ptr<std::vector<std::shared_ptr<Stream>> const> Streams;
 };
 
 class ConversionWorker {
 public:
-  ConversionWorker(ConversionScheduler *scheduler, uint32_t queue_size)
-      : queue(queue_size), id(s_id++), scheduler(scheduler) {}
+  /// \param queue_size Maximum number of work packets taken per refill.
+  ConversionWorker(ConversionScheduler *scheduler, uint32_t queue_size);
   int start();
   int stop();
   int run();
 
 private:
-  moodycamel::ConcurrentQueue<std::unique_ptr<ConversionWorkPacket>> queue;
+  /// Declared before the queue so that packets still in the queue are
+  /// released before the streams they belong to.
+  SchedulerCursor Cursor;
+  ConversionWorkQueue queue;
+  uint32_t QueueSize;
   std::atomic<uint32_t> do_run{0};
-  static std::atomic<uint32_t> s_id;
-  uint32_t id;
   std::thread thr;
   ConversionScheduler *scheduler = nullptr;
 };
 
+/// Hands out PV updates from the streams to the conversion workers.
+///
+/// Each worker owns the shard of streams whose index modulo the number of
+/// workers equals its id and refills from that shard without any lock.  A
+/// worker which finds its own shard empty steals from the other shards.  A
+/// stream is only ever drained by one worker at a time.
 class ConversionScheduler {
 public:
-  explicit ConversionScheduler(Forwarder *main);
+  explicit ConversionScheduler(Streams &streams);
   ~ConversionScheduler();
-  int fill(
-      moodycamel::ConcurrentQueue<std::unique_ptr<ConversionWorkPacket>> &queue,
-      uint32_t nfm, uint32_t wid);
+  /// Registers a new worker.
+  ///
+  /// \return The id of the worker.
+  uint32_t addWorker();
+  int fill(ConversionWorkQueue &queue, uint32_t nfm, SchedulerCursor &Cursor);
+  /// Signal which is notified whenever a PV update is queued in any Stream.
+  std::shared_ptr<WorkSignal> getWorkSignal() const;
 
 private:
-  Forwarder *main = nullptr;
-  size_t sid = 0;
-  std::mutex mx;
+  Streams &streams;
+  std::shared_ptr<WorkSignal> Signal;
+  std::atomic<uint32_t> NumWorkers{0};
 };
 } // namespace Forwarder
@@ -3,9 +3,10 @@
 
 namespace Forwarder {
 
-std::shared_ptr<Converter> Converter::create(FlatBufs::SchemaRegistry const &,
-                                             std::string schema,
-                                             MainOpt const &main_opt) {
+std::shared_ptr<Converter>
+Converter::create(FlatBufs::SchemaRegistry const &, std::string schema,
+                  MainOpt const &main_opt,
+                  std::map<std::string, std::string> const &Config) {
   auto ret = std::make_shared<Converter>();
   ret->schema = schema;
   auto r1 = FlatBufs::SchemaRegistry::items().find(schema);
@@ -25,6 +26,9 @@ std::shared_ptr<Converter> Converter::create(FlatBufs::SchemaRegistry const &,
     auto GlobalConv = main_opt.MainSettings.GlobalConverters.at(schema);
     conv->config(GlobalConv);
   }
+  if (!Config.empty()) {
+    conv->config(Config);
+  }
 
   return ret;
 }
@@ -34,6 +38,25 @@ Converter::convert(FlatBufs::EpicsPVUpdate const &up) {
   return conv->create(up);
 }
 
+std::shared_ptr<BatchedOutput> Converter::getBatchedOutput(
+    std::string const &Topic,
+    std::function<std::unique_ptr<KafkaOutput>()> const &CreateOutput) {
+  std::lock_guard<std::mutex> Lock(BatchedOutputsMutex);
+  auto &Entry = BatchedOutputs[Topic];
+  auto Output = Entry.lock();
+  if (Output != nullptr) {
+    return Output;
+  }
+  auto Batch = conv->createBatch();
+  if (Batch == nullptr) {
+    BatchedOutputs.erase(Topic);
+    return nullptr;
+  }
+  Output = std::make_shared<BatchedOutput>(std::move(Batch), CreateOutput());
+  Entry = Output;
+  return Output;
+}
+
 std::map<std::string, double> Converter::stats() { return conv->getStats(); }
 
 std::string Converter::schema_name() const { return schema; }
@@ -1,26 +1,43 @@
 #pragma once
 
+#include "BatchedOutput.h"
 #include "FlatBufferCreator.h"
 #include "FlatbufferMessage.h"
 #include "MainOpt.h"
 #include "SchemaRegistry.h"
+#include <functional>
 #include <map>
+#include <mutex>
 #include <string>
 
 namespace Forwarder {
 
 class Converter {
 public:
+  /// \param Config Settings of this converter, applied after the global
+  /// settings of the schema.
   static std::shared_ptr<Converter>
   create(FlatBufs::SchemaRegistry const &schema_registry, std::string schema,
-         MainOpt const &main_opt);
+         MainOpt const &main_opt,
+         std::map<std::string, std::string> const &Config = {});
   std::unique_ptr<FlatBufs::FlatbufferMessage>
   convert(FlatBufs::EpicsPVUpdate const &up);
+  /// \param Topic Identifies the topic, including its broker.
+  /// \param CreateOutput Creates the output to the topic on first use.
+  /// \return The output which all conversion paths of this converter to the
+  /// topic share, nullptr if the schema does not batch its messages.
+  std::shared_ptr<BatchedOutput> getBatchedOutput(
+      std::string const &Topic,
+      std::function<std::unique_ptr<KafkaOutput>()> const &CreateOutput);
   std::map<std::string, double> stats();
   std::string schema_name() const;
 
 private:
   std::string schema;
   std::unique_ptr<FlatBufs::FlatBufferCreator> conv;
+  std::mutex BatchedOutputsMutex;
+  /// The outputs are owned by the conversion paths, the last one sends the
+  /// pending batch.
+  std::map<std::string, std::weak_ptr<BatchedOutput>> BatchedOutputs;
 };
 } // namespace Forwarder
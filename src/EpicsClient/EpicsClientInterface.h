@@ -1,6 +1,7 @@
 #pragma once
 #include "EpicsPVUpdate.h"
 #include <memory>
+#include <vector>
 
 namespace Forwarder {
 namespace EpicsClient {
@@ -10,6 +11,22 @@ class EpicsClientInterface {
 public:
   virtual ~EpicsClientInterface() = default;
   virtual int emit(std::shared_ptr<FlatBufs::EpicsPVUpdate> Update) = 0;
+  /// Emits several updates at once, in order.
+  ///
+  /// Implementations should override this if they can pass on a batch more
+  /// cheaply than one update at a time.
+  ///
+  /// \return 0 if all updates were emitted.
+  virtual int emitBatch(
+      std::vector<std::shared_ptr<FlatBufs::EpicsPVUpdate>> const &Updates) {
+    int Result = 0;
+    for (auto const &Update : Updates) {
+      if (emit(Update) != 0) {
+        Result = 1;
+      }
+    }
+    return Result;
+  }
   virtual int stop() = 0;
   virtual void errorInEpics() = 0;
   virtual int status() = 0;
@@ -69,13 +69,20 @@ public:
     // "field(value)"
     // We need to be more explicit here for compatibility with channel access.
     std::string request = "field(value,timeStamp,alarm)";
+    if (zero_copy) {
+      // Elements are only returned to pvAccess after conversion, give the
+      // monitor enough of them to not overrun in the meantime.
+      request = fmt::format("record[queueSize={}]",
+                            FwdMonitorRequester::ZeroCopyQueueSize) +
+                request;
+    }
     PVStructure::shared_pointer pvreq =
         epics::pvData::CreateRequest::create()->createRequest(request);
     if (monitor) {
       monitoringStop();
     }
     monitor_requester.reset(
-        new FwdMonitorRequester(epics_client, channel_name));
+        new FwdMonitorRequester(epics_client, channel_name, zero_copy));
     monitor = channel->createMonitor(monitor_requester, pvreq);
     if (!monitor) {
       LOG(Sev::Warning, "could not create EPICS monitor instance");
@@ -143,19 +150,21 @@ public:
   epics::pvData::Monitor::shared_pointer monitor;
   std::recursive_mutex mx;
   std::string channel_name;
+  bool zero_copy = false;
   EpicsClientInterface *epics_client = nullptr;
   std::unique_ptr<EpicsClientFactoryInit> factory_init;
 };
 
 EpicsClientMonitor::EpicsClientMonitor(
-    ChannelInfo &ChannelInfo,
-    std::shared_ptr<
-        moodycamel::ConcurrentQueue<std::shared_ptr<FlatBufs::EpicsPVUpdate>>>
-        Ring)
-    : EmitQueue(std::move(Ring)) {
+    ChannelInfo &ChannelInfo, std::shared_ptr<PVUpdateQueue> Ring,
+    bool ZeroCopy)
+    : EmitQueue(std::move(Ring)),
+      MonitorToken(EmitQueue->createProducerToken()),
+      TimerToken(EmitQueue->createProducerToken()) {
   Impl.reset(new EpicsClientMonitor_impl(this));
   LOG(Sev::Debug, "channel_name: {}", ChannelInfo.channel_name);
   Impl->channel_name = ChannelInfo.channel_name;
+  Impl->zero_copy = ZeroCopy;
   if (Impl->init(ChannelInfo.provider_type) != 0) {
     Impl.reset();
     throw std::runtime_error("could not initialize");
@@ -169,25 +178,53 @@ EpicsClientMonitor::~EpicsClientMonitor() {
 int EpicsClientMonitor::stop() { return Impl->stop(); }
 
 int EpicsClientMonitor::emit(std::shared_ptr<FlatBufs::EpicsPVUpdate> Update) {
-  CachedUpdate = Update;
-  return emitWithoutCaching(Update);
+  std::atomic_store(&CachedUpdate, Update);
+  return enqueue(&MonitorToken, std::move(Update));
+}
+
+int EpicsClientMonitor::emitBatch(
+    std::vector<std::shared_ptr<FlatBufs::EpicsPVUpdate>> const &Updates) {
+  if (Updates.empty()) {
+    return 0;
+  }
+  std::atomic_store(&CachedUpdate, Updates.back());
+  if (!EmitQueue->enqueueBulk(MonitorToken, Updates)) {
+    return 1;
+  }
+  return 0;
 }
 
 void EpicsClientMonitor::errorInEpics() { status_ = -1; }
 
 void EpicsClientMonitor::emitCachedValue() {
-  if (CachedUpdate != nullptr) {
-    emitWithoutCaching(CachedUpdate);
+  auto Cached = std::atomic_load(&CachedUpdate);
+  if (Cached != nullptr) {
+    // A copy, the cached update itself may still be queued
+    auto Update = std::make_shared<FlatBufs::EpicsPVUpdate>(*Cached);
+    Update->cached_reemit = true;
+    enqueue(&TimerToken, std::move(Update));
   }
 }
+
 int EpicsClientMonitor::emitWithoutCaching(
     std::shared_ptr<FlatBufs::EpicsPVUpdate> Update) {
+  // May be called from any thread, so it can not use a producer token
+  return enqueue(nullptr, std::move(Update));
+}
+
+int EpicsClientMonitor::enqueue(
+    moodycamel::ProducerToken *Token,
+    std::shared_ptr<FlatBufs::EpicsPVUpdate> Update) {
   if (!Update) {
     LOG(Sev::Info, "empty update?");
     // should never happen, ignore
     return 1;
   }
-  EmitQueue->enqueue(Update);
+  if (Token != nullptr) {
+    EmitQueue->enqueue(*Token, std::move(Update));
+  } else {
+    EmitQueue->enqueue(std::move(Update));
+  }
   return 0;
 }
 
@@ -24,18 +24,31 @@ public:
   /// Creates a new implementation and stores it as impl.
   ///
   /// This can then call the functions in the implementation.
-  explicit EpicsClientMonitor(
-      ChannelInfo &ChannelInfo,
-      std::shared_ptr<
-          moodycamel::ConcurrentQueue<std::shared_ptr<FlatBufs::EpicsPVUpdate>>>
-          Ring);
+  ///
+  /// \param ZeroCopy Hold on to the EPICS monitor elements until they are
+  /// converted instead of copying them.
+  explicit EpicsClientMonitor(ChannelInfo &ChannelInfo,
+                              std::shared_ptr<PVUpdateQueue> Ring,
+                              bool ZeroCopy = false);
   ~EpicsClientMonitor() override;
 
   /// Pushes the PV update onto the emit_queue ring buffer.
   ///
+  /// Must only be called from the EPICS monitor callback.
+  ///
   /// \param Update An epics PV update holding the pv structure.
   int emit(std::shared_ptr<FlatBufs::EpicsPVUpdate> Update) override;
 
+  /// Pushes all updates onto the emit_queue ring buffer in one go.
+  ///
+  /// Must only be called from the EPICS monitor callback.
+  ///
+  /// \param Updates The updates from one monitor event.
+  int emitBatch(
+      std::vector<std::shared_ptr<FlatBufs::EpicsPVUpdate>> const &Updates)
+      override;
+
+  /// Pushes the PV update without caching it, safe from any thread.
   int emitWithoutCaching(std::shared_ptr<FlatBufs::EpicsPVUpdate> Update);
 
   /// Calls stop on the client implementation.
@@ -47,13 +60,21 @@ public:
   /// Getter method for EPICS status.
   int status() override { return status_; };
 
+  /// Pushes the last update again, called from the PV update timer thread.
   void emitCachedValue();
 
 private:
+  /// \param Token The token of the calling thread, nullptr if the caller is
+  /// not bound to one.
+  int enqueue(moodycamel::ProducerToken *Token,
+              std::shared_ptr<FlatBufs::EpicsPVUpdate> Update);
+
   std::unique_ptr<EpicsClientMonitor_impl> Impl;
-  std::shared_ptr<
-      moodycamel::ConcurrentQueue<std::shared_ptr<FlatBufs::EpicsPVUpdate>>>
-      EmitQueue;
+  std::shared_ptr<PVUpdateQueue> EmitQueue;
+  /// Each producing thread uses its own token: the EPICS monitor thread
+  /// and the timer thread for emitCachedValue().
+  moodycamel::ProducerToken MonitorToken;
+  moodycamel::ProducerToken TimerToken;
   std::shared_ptr<FlatBufs::EpicsPVUpdate> CachedUpdate;
   std::atomic<int> status_{0};
 };
@@ -7,7 +7,7 @@ namespace Forwarder {
 namespace EpicsClient {
 
 int EpicsClientRandom::emit(std::shared_ptr<FlatBufs::EpicsPVUpdate> up) {
-  EmitQueue->enqueue(up);
+  EmitQueue->enqueue(EmitToken, std::move(up));
   return 1;
 }
 
@@ -2,7 +2,6 @@
 
 #include "EpicsClientInterface.h"
 #include <Stream.h>
-#include <concurrentqueue/concurrentqueue.h>
 #include <random>
 
 namespace Forwarder {
@@ -13,11 +12,9 @@ namespace EpicsClient {
 class EpicsClientRandom : public EpicsClientInterface {
 public:
   explicit EpicsClientRandom(
-      ChannelInfo &channelInfo,
-      std::shared_ptr<
-          moodycamel::ConcurrentQueue<std::shared_ptr<FlatBufs::EpicsPVUpdate>>>
-          RingBuffer)
+      ChannelInfo &channelInfo, std::shared_ptr<PVUpdateQueue> RingBuffer)
       : ChannelInformation(channelInfo), EmitQueue(std::move(RingBuffer)),
+        EmitToken(EmitQueue->createProducerToken()),
         UniformDistribution(0, 100){};
   ~EpicsClientRandom() override = default;
   int emit(std::shared_ptr<FlatBufs::EpicsPVUpdate> up) override;
@@ -36,9 +33,9 @@ private:
 
   ChannelInfo ChannelInformation;
   /// Buffer of (fake) PVUpdates
-  std::shared_ptr<
-      moodycamel::ConcurrentQueue<std::shared_ptr<FlatBufs::EpicsPVUpdate>>>
-      EmitQueue;
+  std::shared_ptr<PVUpdateQueue> EmitQueue;
+  /// Updates are only generated on the fake PV update timer thread
+  moodycamel::ProducerToken EmitToken;
   /// Status is set to 1 if something fails
   int status_{0};
   /// Tools for generating random doubles
@@ -13,10 +13,11 @@ namespace EpicsClient {
 std::atomic<uint32_t> FwdMonitorRequester::GlobalIdCounter{0};
 
 FwdMonitorRequester::FwdMonitorRequester(
-    EpicsClientInterface *EpicsClientMonitor, const std::string &PVName)
+    EpicsClientInterface *EpicsClientMonitor, const std::string &PVName,
+    bool ZeroCopy)
     : ChannelName(PVName),
       RequesterName(fmt::format("FwdMonitorRequester-{}", GlobalIdCounter)),
-      epics_client(EpicsClientMonitor) {
+      epics_client(EpicsClientMonitor), ZeroCopy(ZeroCopy) {
   ++GlobalIdCounter;
   LOG(Sev::Debug, "FwdMonitorRequester {}", RequesterName);
 }
@@ -77,18 +78,29 @@ void FwdMonitorRequester::monitorEvent(
 
     auto Update = std::make_shared<FlatBufs::EpicsPVUpdate>();
     Update->channel = ChannelName;
-    Update->epics_pvstr = epics::pvData::PVStructure::shared_pointer(
-        new ::epics::pvData::PVStructure(ele->pvStructurePtr->getStructure()));
-    Update->epics_pvstr->copyUnchecked(*ele->pvStructurePtr);
-    Monitor->release(ele);
+    if (ZeroCopy) {
+      // The element goes back to the monitor together with the last
+      // reference to the update, which is after conversion.
+      ::epics::pvData::Monitor::weak_pointer WeakMonitor(Monitor);
+      Update->epics_pvstr =
+          Budget.share(ele->pvStructurePtr, [ele, WeakMonitor]() {
+            if (auto M = WeakMonitor.lock()) {
+              M->release(ele);
+            }
+          });
+    }
+    if (Update->epics_pvstr == nullptr) {
+      Update->epics_pvstr = epics::pvData::PVStructure::shared_pointer(
+          new ::epics::pvData::PVStructure(
+              ele->pvStructurePtr->getStructure()));
+      Update->epics_pvstr->copyUnchecked(*ele->pvStructurePtr);
+      Monitor->release(ele);
+    }
     Update->ts_epics_monitor = ts;
     Updates.push_back(Update);
   }
-  for (auto &up : Updates) {
-    auto x = epics_client->emit(up);
-    if (x != 0) {
-      LOG(Sev::Notice, "Cannot push update {}", up->channel);
-    }
+  if (epics_client->emitBatch(Updates) != 0) {
+    LOG(Sev::Notice, "Cannot push {} updates {}", Updates.size(), ChannelName);
   }
 }
 
@@ -1,6 +1,7 @@
 #pragma once
 #include "EpicsClientInterface.h"
 #include "RangeSet.h"
+#include "ZeroCopyBudget.h"
 #include <atomic>
 #include <pv/monitor.h>
 namespace Forwarder {
@@ -15,8 +16,10 @@ public:
   ///
   /// \param EpicsClientMonitor The PV monitor.
   /// \param ChannelName The PV name.
+  /// \param ZeroCopy Pass the monitor elements on without copying them, they
+  /// are released back to the monitor once the update has been converted.
   FwdMonitorRequester(EpicsClientInterface *EpicsClientMonitor,
-                      const std::string &PVName);
+                      const std::string &PVName, bool ZeroCopy = false);
 
   ~FwdMonitorRequester() override;
 
@@ -53,10 +56,16 @@ public:
   /// \param Monitor The PV monitor.
   void unlisten(::epics::pvData::MonitorPtr const &Monitor) override;
 
+  /// Number of elements requested for the monitor queue in zero-copy mode.
+  static uint32_t const ZeroCopyQueueSize = 16;
+
 private:
   std::string ChannelName;
   std::string RequesterName;
   EpicsClientInterface *epics_client = nullptr;
+  bool ZeroCopy = false;
+  /// Keeps one element of the monitor queue free for new updates.
+  ZeroCopyBudget Budget{ZeroCopyQueueSize - 1};
   static std::atomic<uint32_t> GlobalIdCounter;
 };
 }
@@ -0,0 +1,52 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+namespace Forwarder {
+namespace EpicsClient {
+
+/// Limits the number of EPICS monitor elements which are passed on without a
+/// copy.
+///
+/// A shared element is only returned to the monitor once the last reference
+/// to its update is gone, which can be much later with a congested stream.
+/// The monitor has a fixed number of elements, so once the budget is used up
+/// further elements are copied and returned right away.
+class ZeroCopyBudget {
+public:
+  /// \param MaxShared Maximum number of elements shared at the same time.
+  explicit ZeroCopyBudget(uint32_t MaxShared) : MaxShared(MaxShared) {}
+
+  /// Shares the structure of a monitor element.
+  ///
+  /// \param Structure The structure of the element.
+  /// \param Release Called once the last reference to the result is gone.
+  /// \return The shared structure, nullptr if the budget is used up and the
+  /// element has to be copied instead.
+  template <typename T>
+  std::shared_ptr<T> share(std::shared_ptr<T> const &Structure,
+                           std::function<void()> Release) {
+    if (++*Shared > MaxShared) {
+      --*Shared;
+      return nullptr;
+    }
+    // The counter outlives the budget if the update does
+    auto Counter = Shared;
+    return std::shared_ptr<T>(Structure.get(), [Release, Counter](T *) {
+      Release();
+      --*Counter;
+    });
+  }
+
+  /// \return The number of elements shared at the moment.
+  uint32_t getNumShared() const { return Shared->load(); }
+
+private:
+  uint32_t MaxShared;
+  std::shared_ptr<std::atomic<uint32_t>> Shared{
+      std::make_shared<std::atomic<uint32_t>>(0)};
+};
+} // namespace EpicsClient
+} // namespace Forwarder
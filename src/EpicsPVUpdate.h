@@ -19,5 +19,8 @@ struct EpicsPVUpdate {
   std::string channel;
   /// Timestamp when monitorEvent() was called
   uint64_t ts_epics_monitor = 0;
+  /// Set on the copies which the PV update timer emits again, these are not
+  /// subject to the update filter.
+  bool cached_reemit = false;
 };
 }
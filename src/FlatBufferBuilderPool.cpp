@@ -0,0 +1,55 @@
+#include "FlatBufferBuilderPool.h"
+#include <algorithm>
+
+namespace FlatBufs {
+
+FlatBufferBuilderPool::FlatBufferBuilderPool(size_t MaxPooled)
+    : MaxPooled(MaxPooled) {
+  Idle.reserve(MaxPooled);
+}
+
+FlatBufferBuilderPool::~FlatBufferBuilderPool() {
+  for (auto Message : Idle) {
+    delete Message;
+  }
+}
+
+std::unique_ptr<FlatbufferMessage>
+FlatBufferBuilderPool::acquire(uint32_t SizeHint) {
+  std::unique_ptr<FlatbufferMessage> Message;
+  {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    if (!Idle.empty()) {
+      Message.reset(Idle.back());
+      Idle.pop_back();
+    }
+  }
+  if (!Message) {
+    // Reserve enough so that the builder does not have to grow right away
+    Message.reset(
+        new FlatbufferMessage(std::max<uint32_t>(InitialSize, SizeHint)));
+    ++NumAllocations;
+  }
+  Message->Pool = shared_from_this();
+  return Message;
+}
+
+void FlatBufferBuilderPool::release(FlatbufferMessage *Message) {
+  auto Size = static_cast<uint32_t>(Message->builder->GetSize());
+  // Only ever grows, so a plain compare and store is good enough
+  if (Size > InitialSize) {
+    InitialSize = Size;
+  }
+  Message->builder->Clear();
+  Message->data = nullptr;
+  Message->size = 0;
+  {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    if (Idle.size() < MaxPooled) {
+      Idle.push_back(Message);
+      return;
+    }
+  }
+  delete Message;
+}
+} // namespace FlatBufs
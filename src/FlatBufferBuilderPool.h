@@ -0,0 +1,45 @@
+#pragma once
+
+#include "FlatbufferMessage.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace FlatBufs {
+
+/// Recycles FlatbufferMessages together with the buffers of their builders.
+///
+/// Messages are handed back from the Kafka delivery report callback, cleared
+/// and reused for the next conversion.  Builders which have to be created
+/// anew start with the largest message size seen so far.  Must be owned by a
+/// std::shared_ptr because pooled messages keep their pool alive until they
+/// are delivered.
+class FlatBufferBuilderPool
+    : public std::enable_shared_from_this<FlatBufferBuilderPool> {
+public:
+  /// \param MaxPooled Maximum number of idle messages to keep.
+  explicit FlatBufferBuilderPool(size_t MaxPooled = 256);
+  ~FlatBufferBuilderPool();
+
+  /// \param SizeHint Expected size of the message in bytes.
+  /// \return An empty message, taken from the pool if possible.
+  std::unique_ptr<FlatbufferMessage> acquire(uint32_t SizeHint = 0);
+
+  /// Puts a delivered message back into the pool.
+  void release(FlatbufferMessage *Message);
+
+  /// \return Initial size in bytes of newly created builders.
+  uint32_t getInitialSize() const { return InitialSize; }
+
+  /// \return The number of messages created so far.
+  uint64_t getNumAllocations() const { return NumAllocations; }
+
+private:
+  std::mutex Mutex;
+  std::vector<FlatbufferMessage *> Idle;
+  size_t MaxPooled;
+  std::atomic<uint32_t> InitialSize{1024};
+  std::atomic<uint64_t> NumAllocations{0};
+};
+} // namespace FlatBufs
@@ -1,4 +1,5 @@
 #include "FlatBufferCreator.h"
+#include "BatchingFlatBufferCreator.h"
 #include "logger.h"
 
 namespace FlatBufs {
@@ -8,5 +9,9 @@ void FlatBufferCreator::config(
   UNUSED_ARG(KafkaConfiguration);
 }
 
+std::unique_ptr<MessageBatch> FlatBufferCreator::createBatch() {
+  return nullptr;
+}
+
 std::map<std::string, double> FlatBufferCreator::getStats() { return {}; }
 } // namespace FlatBufs
@@ -8,13 +8,18 @@
 namespace FlatBufs {
 
 struct EpicsPVUpdate;
+class MessageBatch;
 
 /// Interface for flat buffer creators for the different schemas
 class FlatBufferCreator {
 public:
   virtual ~FlatBufferCreator() = default;
+  /// \return The message to send, nullptr if there is nothing to send yet.
   virtual std::unique_ptr<FlatbufferMessage>
   create(EpicsPVUpdate const &up) = 0;
+  /// \return A batch for a conversion path to collect the created messages
+  /// in, nullptr if the messages are sent one by one.
+  virtual std::unique_ptr<MessageBatch> createBatch();
   virtual void
   config(std::map<std::string, std::string> const &KafkaConfiguration);
   virtual std::map<std::string, double> getStats();
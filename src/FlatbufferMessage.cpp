@@ -1,4 +1,5 @@
 #include "FlatbufferMessage.h"
+#include "FlatBufferBuilderPool.h"
 #include "logger.h"
 #include <flatbuffers/reflection.h>
 
@@ -21,4 +22,14 @@ FlatbufferMessageSlice FlatbufferMessage::message() {
                                                     builder->GetSize()};
   return ret;
 }
+
+void FlatbufferMessage::release() {
+  if (!Pool) {
+    delete this;
+    return;
+  }
+  // The pool may go away together with its last message
+  auto OwningPool = std::move(Pool);
+  OwningPool->release(this);
+}
 } // namespace FlatBufs
@@ -8,6 +8,8 @@
 
 namespace FlatBufs {
 
+class FlatBufferBuilderPool;
+
 /// Forward declarations for friends.
 
 namespace f142 {
@@ -37,9 +39,17 @@ public:
   /// Called when actually writing to Kafka.
   ///
   /// \return The underlying data.
-  FlatbufferMessageSlice message();
+  virtual FlatbufferMessageSlice message();
+
+  /// Returns the message to the pool it came from, deletes it otherwise.
+  void release() override;
 
   std::unique_ptr<flatbuffers::FlatBufferBuilder> builder;
   FlatbufferMessage(FlatbufferMessage const &) = delete;
+
+private:
+  friend class FlatBufferBuilderPool;
+  /// Set while the message is handed out by a pool.
+  std::shared_ptr<FlatBufferBuilderPool> Pool;
 };
 } // namespace FlatBufs
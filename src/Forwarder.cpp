@@ -2,6 +2,7 @@
 #include "CommandHandler.h"
 #include "Converter.h"
 #include "KafkaOutput.h"
+#include "StateSnapshot.h"
 #include "Stream.h"
 #include "Timer.h"
 #include "helper.h"
@@ -23,6 +24,37 @@ static bool isStopDueToSignal(ForwardingRunState Flag) {
 }
 
 // Little helper
+/// Converter names are left out as they are generated when not given.
+static bool sameConverter(ConverterSettings const &A,
+                          ConverterSettings const &B) {
+  return A.Schema == B.Schema && A.Topic == B.Topic && A.Config == B.Config &&
+         A.Kafka == B.Kafka;
+}
+
+/// \return Whether the settings would set up the same stream, regardless of
+/// the order of the converters.
+static bool sameMapping(StreamSettings const &A, StreamSettings const &B) {
+  if (A.Name != B.Name || A.EpicsProtocol != B.EpicsProtocol ||
+      A.ZeroCopy != B.ZeroCopy || A.QueueSize != B.QueueSize ||
+      A.Overflow != B.Overflow || A.Coalesce != B.Coalesce ||
+      A.Filter.DeadbandAbsolute != B.Filter.DeadbandAbsolute ||
+      A.Filter.DeadbandRelative != B.Filter.DeadbandRelative ||
+      A.Filter.MinIntervalMS != B.Filter.MinIntervalMS ||
+      A.Converters.size() != B.Converters.size()) {
+    return false;
+  }
+  for (auto const &Converter : A.Converters) {
+    auto Found = std::find_if(B.Converters.cbegin(), B.Converters.cend(),
+                              [&Converter](ConverterSettings const &Other) {
+                                return sameConverter(Converter, Other);
+                              });
+    if (Found == B.Converters.cend()) {
+      return false;
+    }
+  }
+  return true;
+}
+
 static KafkaW::BrokerSettings make_broker_opt(MainOpt const &opt) {
   KafkaW::BrokerSettings ret = opt.broker_opt;
   ret.Address = opt.brokers_as_comma_list();
@@ -31,8 +63,10 @@ static KafkaW::BrokerSettings make_broker_opt(MainOpt const &opt) {
 
 /// Main program entry class.
 Forwarder::Forwarder(MainOpt &opt)
-    : main_opt(opt), kafka_instance_set(InstanceSet::Set(make_broker_opt(opt))),
-      conversion_scheduler(this) {
+    : main_opt(opt),
+      kafka_instance_set(InstanceSet::Set(
+          make_broker_opt(opt), opt.MainSettings.ProducersPerBroker)),
+      conversion_scheduler(streams) {
 
   for (size_t i = 0; i < opt.MainSettings.ConversionThreads; ++i) {
     conversion_workers.emplace_back(make_unique<ConversionWorker>(
@@ -59,26 +93,50 @@ Forwarder::Forwarder(MainOpt &opt)
   }
   createPVUpdateTimerIfRequired();
   createFakePVUpdateTimerIfRequired();
+  createBatchFlushTimer();
 
-  for (auto &Stream : main_opt.MainSettings.StreamsInfo) {
-    try {
-      addMapping(Stream);
-    } catch (std::exception &e) {
-      LOG(Sev::Warning, "Could not add mapping: {}  {}", Stream.Name, e.what());
-    }
+  if (!main_opt.StateSnapshotFile.empty()) {
+    StartupStreams = StateSnapshot::readFile(main_opt.StateSnapshotFile);
+    LOG(Sev::Info, "Restoring {} streams from {}", StartupStreams.size(),
+        main_opt.StateSnapshotFile);
   }
+  StartupStreams.insert(StartupStreams.end(),
+                        main_opt.MainSettings.StreamsInfo.begin(),
+                        main_opt.MainSettings.StreamsInfo.end());
 
   if (!main_opt.MainSettings.StatusReportURI.HostPort.empty()) {
     KafkaW::BrokerSettings BrokerSettings;
     BrokerSettings.Address = main_opt.MainSettings.StatusReportURI.HostPort;
     status_producer = std::make_shared<KafkaW::Producer>(BrokerSettings);
+    status_producer->startPollThread(100);
     status_producer_topic = ::make_unique<KafkaW::ProducerTopic>(
         status_producer, main_opt.MainSettings.StatusReportURI.Topic);
   }
+
+  // Started last, the destructor which joins it does not run if the
+  // constructor throws
+  if (!StartupStreams.empty()) {
+    StartupThread = std::thread([this]() {
+      auto NotAdded = addMappings(StartupStreams);
+      {
+        std::lock_guard<std::mutex> Lock(RecordedMappingsMutex);
+        for (auto &StreamInfo : NotAdded) {
+          if (RecordedMappings.find(StreamInfo.Name) ==
+              RecordedMappings.end()) {
+            UnrestoredMappings.push_back(std::move(StreamInfo));
+          }
+        }
+      }
+      RestoreDone = true;
+    });
+  } else {
+    RestoreDone = true;
+  }
 }
 
 Forwarder::~Forwarder() {
   LOG(Sev::Debug, "~Main");
+  joinStartupThread();
   streams.clearStreams();
   conversion_workers_clear();
   converters_clear();
@@ -101,6 +159,19 @@ void Forwarder::createFakePVUpdateTimerIfRequired() {
   }
 }
 
+/// Granularity of the batch deadlines, independent of the main loop.
+static std::chrono::milliseconds const BatchFlushInterval{20};
+
+void Forwarder::createBatchFlushTimer() {
+  std::shared_ptr<Sleeper> IntervalSleeper = std::make_shared<RealSleeper>();
+  BatchFlushTimer = ::make_unique<Timer>(BatchFlushInterval, IntervalSleeper);
+  BatchFlushTimer->addCallback([this]() {
+    for (auto const &Stream : *streams.getStreamsSnapshot()) {
+      Stream->flushBatches();
+    }
+  });
+}
+
 int Forwarder::conversion_workers_clear() {
   LOG(Sev::Debug, "Main::conversion_workers_clear()  begin");
   std::lock_guard<std::mutex> lock(conversion_workers_mx);
@@ -140,6 +211,7 @@ void Forwarder::forward_epics_to_kafka() {
   auto Dt = MS(main_opt.MainSettings.MainPollInterval);
   auto t_lf_last = CLK::now();
   auto t_status_last = CLK::now();
+  auto t_snapshot_last = CLK::now();
   ConfigCB config_cb(*this);
   {
     std::lock_guard<std::mutex> lock(conversion_workers_mx);
@@ -156,6 +228,8 @@ void Forwarder::forward_epics_to_kafka() {
     GenerateFakePVUpdateTimer->start();
   }
 
+  BatchFlushTimer->start();
+
   while (ForwardingRunFlag.load() == ForwardingRunState::RUN) {
     auto do_stats = false;
     auto t1 = CLK::now();
@@ -164,10 +238,13 @@ void Forwarder::forward_epics_to_kafka() {
         config_listener->poll(config_cb);
       }
       streams.checkStreamStatus();
+      streams.reclaimRetired();
       t_lf_last = t1;
       do_stats = true;
     }
-    kafka_instance_set->poll();
+    for (auto const &Stream : *streams.getStreamsSnapshot()) {
+      Stream->flushConversionPaths();
+    }
 
     auto t2 = CLK::now();
     auto dt = std::chrono::duration_cast<MS>(t2 - t1);
@@ -181,6 +258,10 @@ void Forwarder::forward_epics_to_kafka() {
       kafka_instance_set->log_stats();
       report_stats(dt.count());
     }
+    if (t2 - t_snapshot_last > MS(10000)) {
+      writeStateSnapshot();
+      t_snapshot_last = t2;
+    }
     if (dt >= Dt) {
       LOG(Sev::Error, "slow main loop: {}", dt.count());
     } else {
@@ -191,8 +272,13 @@ void Forwarder::forward_epics_to_kafka() {
     LOG(Sev::Info, "Forwarder stopping due to signal.");
   }
   LOG(Sev::Info, "Main::forward_epics_to_kafka shutting down");
+  joinStartupThread();
+  writeStateSnapshot();
   conversion_workers_clear();
   streams.clearStreams();
+  while (streams.reclaimRetired() > 0) {
+    std::this_thread::sleep_for(MS(10));
+  }
 
   if (PVUpdateTimer != nullptr) {
     PVUpdateTimer->triggerStop();
@@ -204,6 +290,10 @@ void Forwarder::forward_epics_to_kafka() {
     GenerateFakePVUpdateTimer->waitForStop();
   }
 
+  // The batches left over were sent when their streams were reclaimed
+  BatchFlushTimer->triggerStop();
+  BatchFlushTimer->waitForStop();
+
   LOG(Sev::Info, "ForwardingStatus::STOPPED");
   forwarding_status.store(ForwardingStatus::STOPPED);
 }
@@ -212,8 +302,8 @@ void Forwarder::report_status() {
   using nlohmann::json;
   auto Status = json::object();
   auto Streams = json::array();
-  auto StreamVector = streams.getStreams();
-  std::transform(StreamVector.cbegin(), StreamVector.cend(),
+  auto StreamVector = streams.getStreamsSnapshot();
+  std::transform(StreamVector->cbegin(), StreamVector->cend(),
                  std::back_inserter(Streams),
                  [](const std::shared_ptr<Stream> &CStream) {
                    return CStream->getStatusJson();
@@ -259,6 +349,11 @@ void Forwarder::report_stats(int dt) {
       StatsBuffer.write(",msg_too_large={}", s.msg_too_large);
       StatsBuffer.write(",produced_bytes={}", double(s.produced_bytes));
       StatsBuffer.write(",outq={}", s.out_queue);
+      for (size_t Bucket = 0; Bucket < s.delivery_latency.Counts.size();
+           ++Bucket) {
+        StatsBuffer.write(",delivery_latency_{}={}", Bucket,
+                          s.delivery_latency.Counts[Bucket].load());
+      }
       StatsBuffer.write("\n");
       ++i1;
     }
@@ -313,8 +408,9 @@ URI Forwarder::createTopicURI(ConverterSettings const &ConverterInfo) {
   return TopicURI;
 }
 
-void Forwarder::pushConverterToStream(ConverterSettings const &ConverterInfo,
-                                      std::shared_ptr<Stream> &Stream) {
+std::unique_ptr<ConversionPath>
+Forwarder::createConversionPath(ConverterSettings const &ConverterInfo,
+                                ChannelInfo const &ChannelInfo) {
 
   // Check schema exists
   auto r1 = FlatBufs::SchemaRegistry::items().find(ConverterInfo.Schema);
@@ -333,39 +429,86 @@ void Forwarder::pushConverterToStream(ConverterSettings const &ConverterInfo,
       ConverterShared = ConverterIt->second.lock();
       if (!ConverterShared) {
         ConverterShared = Converter::create(main_opt.schema_registry,
-                                            ConverterInfo.Schema, main_opt);
+                                            ConverterInfo.Schema, main_opt,
+                                            ConverterInfo.Config);
         converters[ConverterInfo.Name] =
             std::weak_ptr<Converter>(ConverterShared);
       }
     } else {
       ConverterShared = Converter::create(main_opt.schema_registry,
-                                          ConverterInfo.Schema, main_opt);
+                                          ConverterInfo.Schema, main_opt,
+                                          ConverterInfo.Config);
       converters[ConverterInfo.Name] =
           std::weak_ptr<Converter>(ConverterShared);
     }
   } else {
     ConverterShared = Converter::create(main_opt.schema_registry,
-                                        ConverterInfo.Schema, main_opt);
+                                        ConverterInfo.Schema, main_opt,
+                                        ConverterInfo.Config);
   }
   if (!ConverterShared) {
     throw MappingAddException("Cannot create a converter");
   }
 
-  // Create a conversion path then add it
-  auto Topic = kafka_instance_set->SetUpProducerTopic(std::move(TopicURI));
-  auto cp = ::make_unique<ConversionPath>(
-      std::move(ConverterShared), ::make_unique<KafkaOutput>(std::move(Topic)));
-
-  Stream->addConverter(std::move(cp));
+  // Channels sharing a named converter share its batches, which all carry
+  // the converter name as key and therefore go to the same partition.
+  auto const &Key = ConverterInfo.Name.empty() ? ChannelInfo.channel_name
+                                               : ConverterInfo.Name;
+  auto CreateOutput = [&]() {
+    auto Topic =
+        kafka_instance_set->SetUpProducerTopic(TopicURI, ConverterInfo.Kafka);
+    return ::make_unique<KafkaOutput>(std::move(Topic), Key);
+  };
+
+  auto Batched =
+      ConverterShared->getBatchedOutput(TopicURI.getURIString(), CreateOutput);
+  if (Batched != nullptr) {
+    return ::make_unique<ConversionPath>(std::move(ConverterShared),
+                                         std::move(Batched));
+  }
+  return ::make_unique<ConversionPath>(std::move(ConverterShared),
+                                       CreateOutput());
 }
 
 void Forwarder::addMapping(StreamSettings const &StreamInfo) {
-  auto lock = get_lock_streams();
   try {
     ChannelInfo ChannelInfo{StreamInfo.EpicsProtocol, StreamInfo.Name};
     std::shared_ptr<Stream> Stream;
     if (GenerateFakePVUpdateTimer != nullptr) {
-      Stream = findOrAddStream<EpicsClient::EpicsClientRandom>(ChannelInfo);
+      Stream = findOrAddStream<EpicsClient::EpicsClientRandom>(ChannelInfo,
+                                                               StreamInfo);
+    } else {
+      Stream = findOrAddStream<EpicsClient::EpicsClientMonitor>(
+          ChannelInfo, StreamInfo, StreamInfo.ZeroCopy);
+    }
+
+    // Setting up the Kafka topics may take a while, so do it before taking
+    // the lock which keeps the commands out.
+    auto Filter = UpdateFilter::create(StreamInfo.Filter);
+    std::vector<std::unique_ptr<ConversionPath>> Paths;
+    for (auto &Converter : StreamInfo.Converters) {
+      Paths.push_back(createConversionPath(Converter, ChannelInfo));
+    }
+
+    {
+      // A command may stop the channel while it was being set up.  Attach
+      // the paths only to a registered stream and keep the commands out
+      // until the mapping is recorded.
+      auto Lock = get_lock_streams();
+      if (streams.getStreamByChannelName(ChannelInfo.channel_name) !=
+          Stream) {
+        throw MappingAddException(
+            fmt::format("Channel {} was stopped while it was being added",
+                        ChannelInfo.channel_name));
+      }
+      Stream->setFilter(std::move(Filter));
+      for (auto &Path : Paths) {
+        Stream->addConverter(std::move(Path));
+      }
+      recordMapping(StreamInfo, Stream);
+    }
+
+    if (GenerateFakePVUpdateTimer != nullptr) {
       auto Client = Stream->getEpicsClient();
       auto RandomClient =
           dynamic_cast<EpicsClient::EpicsClientRandom *>(Client.get());
@@ -373,8 +516,6 @@ void Forwarder::addMapping(StreamSettings const &StreamInfo) {
         GenerateFakePVUpdateTimer->addCallback(
             [Client, RandomClient]() { RandomClient->generateFakePVUpdate(); });
       }
-    } else {
-      Stream = findOrAddStream<EpicsClient::EpicsClientMonitor>(ChannelInfo);
     }
 
     if (PVUpdateTimer != nullptr) {
@@ -384,29 +525,225 @@ void Forwarder::addMapping(StreamSettings const &StreamInfo) {
       PVUpdateTimer->addCallback(
           [Client, PeriodicClient]() { PeriodicClient->emitCachedValue(); });
     }
-
-    for (auto &Converter : StreamInfo.Converters) {
-      pushConverterToStream(Converter, Stream);
-    }
   } catch (std::runtime_error &e) {
     std::throw_with_nested(MappingAddException("Cannot add stream"));
   }
 }
 
-template <typename T>
-std::shared_ptr<Stream> Forwarder::findOrAddStream(ChannelInfo &ChannelInfo) {
+std::vector<StreamSettings>
+Forwarder::addMappings(std::vector<StreamSettings> const &StreamsInfo) {
+  // Setting up a stream mostly waits for EPICS and Kafka, so use more threads
+  // than cores.
+  size_t const MaxThreads = 16;
+  size_t const NumThreads = std::min(MaxThreads, StreamsInfo.size());
+  size_t const ProgressStep = std::max<size_t>(StreamsInfo.size() / 10, 1000);
+  std::atomic<size_t> Next{0};
+  std::atomic<size_t> NumDone{0};
+  std::atomic<size_t> NumFailed{0};
+  // Each entry is written by the thread which handles the mapping
+  std::vector<char> Added(StreamsInfo.size(), 0);
+  auto Start = std::chrono::steady_clock::now();
+  auto AddNext = [&]() {
+    while (ForwardingRunFlag.load() == ForwardingRunState::RUN) {
+      auto Index = Next++;
+      if (Index >= StreamsInfo.size()) {
+        break;
+      }
+      try {
+        addMapping(StreamsInfo[Index]);
+        Added[Index] = 1;
+      } catch (std::exception &e) {
+        ++NumFailed;
+        LOG(Sev::Warning, "Could not add mapping: {}  {}",
+            StreamsInfo[Index].Name, e.what());
+      }
+      auto Done = ++NumDone;
+      if (Done % ProgressStep == 0) {
+        LOG(Sev::Info, "Added {} of {} streams", Done, StreamsInfo.size());
+      }
+    }
+  };
+  std::vector<std::thread> Threads;
+  for (size_t i = 1; i < NumThreads; ++i) {
+    Threads.emplace_back(AddNext);
+  }
+  AddNext();
+  for (auto &Thread : Threads) {
+    Thread.join();
+  }
+  auto Duration = std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now() - Start);
+  LOG(Sev::Info, "Added {} streams in {} ms, {} failed",
+      NumDone.load() - NumFailed.load(), Duration.count(), NumFailed.load());
+  std::vector<StreamSettings> NotAdded;
+  for (size_t i = 0; i < StreamsInfo.size(); ++i) {
+    if (!Added[i]) {
+      NotAdded.push_back(StreamsInfo[i]);
+    }
+  }
+  return NotAdded;
+}
+
+void Forwarder::setMappings(std::vector<StreamSettings> const &StreamsInfo) {
+  std::map<std::string, StreamSettings const *> Wanted;
+  for (auto const &StreamInfo : StreamsInfo) {
+    if (!Wanted.emplace(StreamInfo.Name, &StreamInfo).second) {
+      LOG(Sev::Warning, "Channel {} is listed more than once, using the first",
+          StreamInfo.Name);
+    }
+  }
+  std::vector<std::string> ToStop;
+  std::vector<StreamSettings> ToAdd;
+  {
+    std::lock_guard<std::mutex> Lock(RecordedMappingsMutex);
+    // The set replaces everything, including what the startup could not add
+    UnrestoredMappings.clear();
+    for (auto const &Stream : *streams.getStreamsSnapshot()) {
+      auto const &Name = Stream->getChannelInfo().channel_name;
+      if (Wanted.find(Name) == Wanted.end()) {
+        ToStop.push_back(Name);
+      }
+    }
+    for (auto const &Entry : Wanted) {
+      auto Running = streams.getStreamByChannelName(Entry.first);
+      if (Running != nullptr) {
+        auto Recorded = RecordedMappings.find(Entry.first);
+        if (Recorded != RecordedMappings.end() &&
+            Recorded->second.ForStream.lock() == Running &&
+            sameMapping(Recorded->second.Settings, *Entry.second)) {
+          continue;
+        }
+        ToStop.push_back(Entry.first);
+      }
+      ToAdd.push_back(*Entry.second);
+    }
+  }
+  for (auto const &Name : ToStop) {
+    stopChannel(Name);
+  }
+  LOG(Sev::Info, "Set {} streams: {} stopped, {} to add", Wanted.size(),
+      ToStop.size(), ToAdd.size());
+  addMappings(ToAdd);
+}
+
+void Forwarder::stopChannel(std::string const &ChannelName) {
+  forgetUnrestoredMapping(ChannelName);
+  auto Lock = get_lock_streams();
+  streams.stopChannel(ChannelName);
+}
+
+void Forwarder::stopAllChannels() {
+  {
+    std::lock_guard<std::mutex> Lock(RecordedMappingsMutex);
+    UnrestoredMappings.clear();
+  }
+  auto Lock = get_lock_streams();
+  streams.clearStreams();
+}
+
+void Forwarder::forgetUnrestoredMapping(std::string const &ChannelName) {
+  std::lock_guard<std::mutex> Lock(RecordedMappingsMutex);
+  UnrestoredMappings.erase(
+      std::remove_if(UnrestoredMappings.begin(), UnrestoredMappings.end(),
+                     [&ChannelName](StreamSettings const &StreamInfo) {
+                       return StreamInfo.Name == ChannelName;
+                     }),
+      UnrestoredMappings.end());
+}
+
+void Forwarder::recordMapping(StreamSettings const &StreamInfo,
+                              std::shared_ptr<Stream> const &ForStream) {
+  forgetUnrestoredMapping(StreamInfo.Name);
+  std::lock_guard<std::mutex> Lock(RecordedMappingsMutex);
+  auto &Recorded = RecordedMappings[StreamInfo.Name];
+  if (Recorded.ForStream.lock() != ForStream) {
+    // New stream, or the channel was stopped and added again
+    Recorded.ForStream = ForStream;
+    Recorded.Settings = StreamInfo;
+    return;
+  }
+  // Further converters for a stream which already exists
+  auto &Converters = Recorded.Settings.Converters;
+  for (auto const &Converter : StreamInfo.Converters) {
+    auto Found = std::find_if(
+        Converters.cbegin(), Converters.cend(),
+        [&Converter](ConverterSettings const &Existing) {
+          return Existing.Topic == Converter.Topic &&
+                 Existing.Schema == Converter.Schema;
+        });
+    if (Found == Converters.cend()) {
+      Converters.push_back(Converter);
+    }
+  }
+}
+
+void Forwarder::writeStateSnapshot() {
+  if (!RestoreDone.load()) {
+    // Neither prune nor write a partial set, the old snapshot stays intact
+    return;
+  }
+  std::vector<StreamSettings> Active;
+  {
+    std::lock_guard<std::mutex> Lock(RecordedMappingsMutex);
+    for (auto It = RecordedMappings.begin(); It != RecordedMappings.end();) {
+      auto ForStream = It->second.ForStream.lock();
+      if (ForStream == nullptr ||
+          streams.getStreamByChannelName(It->first) != ForStream) {
+        It = RecordedMappings.erase(It);
+      } else {
+        Active.push_back(It->second.Settings);
+        ++It;
+      }
+    }
+    Active.insert(Active.end(), UnrestoredMappings.begin(),
+                  UnrestoredMappings.end());
+  }
+  // Pruned above also without a snapshot file, setMappings() uses the records
+  if (main_opt.StateSnapshotFile.empty()) {
+    return;
+  }
+  auto Image = StateSnapshot::serialize(Active);
+  if (Image == LastStateSnapshot) {
+    return;
+  }
+  if (StateSnapshot::writeFile(main_opt.StateSnapshotFile, Image)) {
+    LastStateSnapshot = std::move(Image);
+  }
+}
+
+void Forwarder::joinStartupThread() {
+  if (StartupThread.joinable()) {
+    StartupThread.join();
+  }
+}
+
+template <typename T, typename... ClientArgs>
+std::shared_ptr<Stream>
+Forwarder::findOrAddStream(ChannelInfo &ChannelInfo,
+                           StreamSettings const &StreamInfo,
+                           ClientArgs &&... Args) {
   std::shared_ptr<Stream> FoundStream =
       streams.getStreamByChannelName(ChannelInfo.channel_name);
   if (FoundStream != nullptr) {
     return FoundStream;
   }
-  auto PVUpdateRing = std::make_shared<
-      moodycamel::ConcurrentQueue<std::shared_ptr<FlatBufs::EpicsPVUpdate>>>();
-  auto client = std::make_shared<T>(ChannelInfo, PVUpdateRing);
+  // The client is created without holding the lock, so that several channels
+  // can be created at the same time.
+  auto PVUpdateRing = std::make_shared<PVUpdateQueue>(
+      conversion_scheduler.getWorkSignal(), StreamInfo.QueueSize,
+      StreamInfo.Overflow, StreamInfo.Coalesce);
+  auto client = std::make_shared<T>(ChannelInfo, PVUpdateRing,
+                                    std::forward<ClientArgs>(Args)...);
   auto EpicsClientInterfacePtr =
       std::static_pointer_cast<EpicsClient::EpicsClientInterface>(client);
   auto NewStream = std::make_shared<Stream>(
       ChannelInfo, EpicsClientInterfacePtr, PVUpdateRing);
+  auto lock = get_lock_streams();
+  FoundStream = streams.getStreamByChannelName(ChannelInfo.channel_name);
+  if (FoundStream != nullptr) {
+    // Added by another thread in the meantime, ours is stopped on destruction
+    return FoundStream;
+  }
   streams.add(NewStream);
   return NewStream;
 }
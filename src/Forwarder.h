@@ -10,6 +10,7 @@
 #include <map>
 #include <mutex>
 #include <stdexcept>
+#include <thread>
 
 namespace Forwarder {
 
@@ -44,6 +45,25 @@ public:
   ~Forwarder();
   void forward_epics_to_kafka();
   void addMapping(StreamSettings const &StreamInfo);
+  /// Adds the mappings from several threads and logs the progress.
+  ///
+  /// Streams forward as soon as they are added, while the remaining ones are
+  /// still being set up.  Mappings which can not be added are logged.
+  ///
+  /// \return The mappings which failed or were skipped because forwarding
+  /// stops.
+  std::vector<StreamSettings>
+  addMappings(std::vector<StreamSettings> const &StreamsInfo);
+  /// Makes the forwarded streams match the given ones.
+  ///
+  /// Streams which are not listed are stopped, new and changed ones are
+  /// (re)added and unchanged ones keep forwarding without interruption.
+  void setMappings(std::vector<StreamSettings> const &StreamsInfo);
+  /// Stops the stream of the channel, waits for a mapping which is being
+  /// attached to it.
+  void stopChannel(std::string const &ChannelName);
+  /// Stops all streams, waits for mappings which are being attached.
+  void stopAllChannels();
   void stopForwarding();
   void stopForwardingDueToSignal();
   void report_status();
@@ -58,13 +78,18 @@ public:
 private:
   void createFakePVUpdateTimerIfRequired();
   void createPVUpdateTimerIfRequired();
-  template <typename T>
-  std::shared_ptr<Stream> findOrAddStream(ChannelInfo &ChannelInfo);
+  void createBatchFlushTimer();
+  template <typename T, typename... ClientArgs>
+  std::shared_ptr<Stream> findOrAddStream(ChannelInfo &ChannelInfo,
+                                          StreamSettings const &StreamInfo,
+                                          ClientArgs &&... Args);
   MainOpt &main_opt;
   std::shared_ptr<InstanceSet> kafka_instance_set;
   std::unique_ptr<Config::Listener> config_listener;
   std::unique_ptr<Timer> PVUpdateTimer;
   std::unique_ptr<Timer> GenerateFakePVUpdateTimer;
+  /// Sends the batches of the conversion paths once their deadline passed.
+  std::unique_ptr<Timer> BatchFlushTimer;
   std::mutex converters_mutex;
   std::map<std::string, std::weak_ptr<Converter>> converters;
   std::mutex streams_mutex;
@@ -76,9 +101,35 @@ private:
   std::shared_ptr<KafkaW::Producer> status_producer;
   std::unique_ptr<KafkaW::ProducerTopic> status_producer_topic;
   std::atomic<ForwardingRunState> ForwardingRunFlag{ForwardingRunState::RUN};
+  /// Adds the streams given at startup while forwarding already runs.
+  std::thread StartupThread;
+  std::vector<StreamSettings> StartupStreams;
+  void joinStartupThread();
+  /// Settings of an added stream, kept for the state snapshot and for
+  /// setMappings().
+  struct RecordedMapping {
+    std::weak_ptr<Stream> ForStream;
+    StreamSettings Settings;
+  };
+  std::mutex RecordedMappingsMutex;
+  std::map<std::string, RecordedMapping> RecordedMappings;
+  /// Mappings from the startup which could not be added.  They stay in the
+  /// state snapshot until the channel is added, stopped or set anew.
+  /// Guarded by RecordedMappingsMutex.
+  std::vector<StreamSettings> UnrestoredMappings;
+  /// Snapshots are only written once the startup streams are handled,
+  /// otherwise an interrupted restore would shrink the snapshot.
+  std::atomic<bool> RestoreDone{false};
+  void forgetUnrestoredMapping(std::string const &ChannelName);
+  std::vector<char> LastStateSnapshot;
+  void recordMapping(StreamSettings const &StreamInfo,
+                     std::shared_ptr<Stream> const &ForStream);
+  void writeStateSnapshot();
   void raiseForwardingFlag(ForwardingRunState ToBeRaised);
-  void pushConverterToStream(ConverterSettings const &ConverterInfo,
-                             std::shared_ptr<Stream> &Stream);
+  /// Sets up the converter and the Kafka topic of a conversion path.
+  std::unique_ptr<ConversionPath>
+  createConversionPath(ConverterSettings const &ConverterInfo,
+                       ChannelInfo const &ChannelInfo);
 };
 
 extern std::atomic<uint64_t> g__total_msgs_to_kafka;
@@ -7,19 +7,23 @@ namespace Forwarder {
 static std::mutex ProducerMutex;
 static std::shared_ptr<InstanceSet> kset;
 
+/// How long the poll thread of a producer blocks in a single poll.
+static int const PollThreadTimeoutMS = 10;
+
 std::unique_lock<std::mutex> InstanceSet::getProducersByHostMutexLock() {
   std::unique_lock<std::mutex> lock(ProducersByHostMutex);
   return lock;
 }
 
 std::shared_ptr<InstanceSet>
-InstanceSet::Set(KafkaW::BrokerSettings BrokerSettings) {
+InstanceSet::Set(KafkaW::BrokerSettings BrokerSettings,
+                 size_t ProducersPerBroker) {
   std::lock_guard<std::mutex> lock(ProducerMutex);
   LOG(Sev::Warning, "Kafka InstanceSet with rdkafka version: {}",
       RdKafka::version());
   if (!kset) {
     BrokerSettings.PollTimeoutMS = 0;
-    kset.reset(new InstanceSet(BrokerSettings));
+    kset.reset(new InstanceSet(BrokerSettings, ProducersPerBroker));
   }
   return kset;
 }
@@ -29,52 +33,137 @@ void InstanceSet::clear() {
   kset.reset();
 }
 
-InstanceSet::InstanceSet(KafkaW::BrokerSettings BrokerSettings)
-    : BrokerSettings(std::move(BrokerSettings)) {}
+InstanceSet::InstanceSet(KafkaW::BrokerSettings BrokerSettings,
+                         size_t ProducersPerBroker)
+    : BrokerSettings(std::move(BrokerSettings)),
+      ProducersPerBroker(std::max<size_t>(ProducersPerBroker, 1)) {}
+
+std::shared_ptr<KafkaW::Producer> InstanceSet::leastLoadedProducer(
+    std::vector<std::shared_ptr<KafkaW::Producer>> const &Producers) {
+  // The output queue shows the current load, with equal queues the producer
+  // with the fewest topics is taken.
+  return *std::min_element(
+      Producers.cbegin(), Producers.cend(),
+      [](std::shared_ptr<KafkaW::Producer> const &A,
+         std::shared_ptr<KafkaW::Producer> const &B) {
+        auto QueueA = A->outputQueueLength();
+        auto QueueB = B->outputQueueLength();
+        if (QueueA != QueueB) {
+          return QueueA < QueueB;
+        }
+        return A->NumTopics.load() < B->NumTopics.load();
+      });
+}
+
+/// Splits the settings into those librdkafka accepts for a topic and those
+/// which have to go to the producer.
+static void splitKafkaSettings(
+    std::map<std::string, std::string> const &KafkaSettings,
+    std::map<std::string, std::string> &TopicSettings,
+    std::map<std::string, std::string> &ProducerSettings) {
+  std::unique_ptr<RdKafka::Conf> TopicConf(
+      RdKafka::Conf::create(RdKafka::Conf::CONF_TOPIC));
+  std::string ErrStr;
+  for (auto const &Setting : KafkaSettings) {
+    if (TopicConf->set(Setting.first, Setting.second, ErrStr) ==
+        RdKafka::Conf::CONF_UNKNOWN) {
+      ProducerSettings.insert(Setting);
+    } else {
+      TopicSettings.insert(Setting);
+    }
+  }
+}
 
-KafkaW::ProducerTopic InstanceSet::SetUpProducerTopic(Forwarder::URI uri) {
+KafkaW::ProducerTopic InstanceSet::SetUpProducerTopic(
+    Forwarder::URI uri,
+    std::map<std::string, std::string> const &KafkaSettings) {
   LOG(Sev::Debug, "InstanceSet::producer_topic  for:  {}, {}", uri.HostPort,
       uri.Topic);
-  auto host_port = uri.HostPort;
-  auto it = ProducersByHost.find(host_port);
-  if (it != ProducersByHost.end()) {
-    return KafkaW::ProducerTopic(it->second, uri.Topic);
+  std::map<std::string, std::string> TopicSettings;
+  std::map<std::string, std::string> ProducerSettings;
+  splitKafkaSettings(KafkaSettings, TopicSettings, ProducerSettings);
+
+  // Producers with custom settings are only shared between topics which use
+  // the very same settings.
+  auto ProducerKey = uri.HostPort;
+  for (auto const &Setting : ProducerSettings) {
+    ProducerKey += fmt::format(" {}={}", Setting.first, Setting.second);
   }
-  auto BrokerSettings = this->BrokerSettings;
-  BrokerSettings.Address = host_port;
-  auto Producer = std::make_shared<KafkaW::Producer>(BrokerSettings);
+
+  // Topics are created while holding the lock, so that the next caller
+  // already sees them in the topic count of their producer.
   {
     auto lock = getProducersByHostMutexLock();
-    ProducersByHost[host_port] = Producer;
+    auto &Producers = ProducersByHost[ProducerKey];
+    auto &NumStarting = NumProducersStarting[ProducerKey];
+    // Rather wait for a producer which is being started than start more
+    // producers than configured.
+    ProducerStarted.wait(lock, [&Producers, &NumStarting, this]() {
+      return !Producers.empty() || NumStarting < ProducersPerBroker;
+    });
+    if (Producers.size() + NumStarting >= ProducersPerBroker) {
+      return KafkaW::ProducerTopic(leastLoadedProducer(Producers), uri.Topic,
+                                   TopicSettings);
+    }
+    ++NumStarting;
   }
-  return KafkaW::ProducerTopic(Producer, uri.Topic);
-}
 
-int InstanceSet::poll() {
-  auto lock = getProducersByHostMutexLock();
-  for (auto const &ProducerMap : ProducersByHost) {
-    auto &Producer = ProducerMap.second;
-    Producer->poll();
+  // Starting a producer takes a while, other topics are set up meanwhile.
+  std::shared_ptr<KafkaW::Producer> Producer;
+  try {
+    auto BrokerSettings = this->BrokerSettings;
+    BrokerSettings.Address = uri.HostPort;
+    for (auto const &Setting : ProducerSettings) {
+      BrokerSettings.KafkaConfiguration[Setting.first] = Setting.second;
+    }
+    Producer = std::make_shared<KafkaW::Producer>(BrokerSettings);
+    Producer->startPollThread(PollThreadTimeoutMS);
+  } catch (...) {
+    auto lock = getProducersByHostMutexLock();
+    --NumProducersStarting[ProducerKey];
+    ProducerStarted.notify_all();
+    throw;
   }
-  return 0;
+
+  auto lock = getProducersByHostMutexLock();
+  --NumProducersStarting[ProducerKey];
+  ProducersByHost[ProducerKey].push_back(Producer);
+  ProducerStarted.notify_all();
+  return KafkaW::ProducerTopic(Producer, uri.Topic, TopicSettings);
 }
 
 void InstanceSet::log_stats() {
   auto lock = getProducersByHostMutexLock();
   for (auto const &m : ProducersByHost) {
-    auto &Producer = m.second;
-    LOG(Sev::Info, "Broker: {}  total: {}  outq: {}", m.first,
-        Producer->TotalMessagesProduced, Producer->outputQueueLength());
+    for (size_t i = 0; i < m.second.size(); ++i) {
+      auto &Producer = m.second[i];
+      fmt::MemoryWriter Latency;
+      auto const &Histogram = Producer->Stats.delivery_latency;
+      for (size_t Bucket = 0; Bucket < Histogram.Counts.size(); ++Bucket) {
+        if (auto Count = Histogram.Counts[Bucket].load()) {
+          auto Bound = KafkaW::LatencyHistogram::upperBoundMS(Bucket);
+          Latency.write(Bound > 0 ? " <{}ms: {}" : " longer: {1}", Bound,
+                        Count);
+        }
+      }
+      LOG(Sev::Info,
+          "Broker: {}  producer: {}  total: {}  outq: {}  latency:{}", m.first,
+          i, Producer->TotalMessagesProduced, Producer->outputQueueLength(),
+          Latency.str());
+    }
   }
 }
 
 std::vector<KafkaW::ProducerStats> InstanceSet::getStatsForAllProducers() {
   std::vector<KafkaW::ProducerStats> ret;
   auto lock = getProducersByHostMutexLock();
-  std::transform(
-      ProducersByHost.cbegin(), ProducersByHost.cend(), std::back_inserter(ret),
-      [](const std::pair<std::string, std::shared_ptr<KafkaW::Producer>>
-             &CProducer) { return CProducer.second->Stats; });
+  for (auto const &ProducerMap : ProducersByHost) {
+    std::transform(ProducerMap.second.cbegin(), ProducerMap.second.cend(),
+                   std::back_inserter(ret),
+                   [](std::shared_ptr<KafkaW::Producer> const &CProducer) {
+                     return CProducer->Stats;
+                   });
+  }
   return ret;
 }
 }
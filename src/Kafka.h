@@ -2,10 +2,11 @@
 
 /// \file
 /// Manage the running Kafka producer instances.
-/// Simple load balance over the available producers.
+/// Simple load balance over the available producers of a broker.
 
 #include "URI.h"
 #include <atomic>
+#include <condition_variable>
 #include <map>
 #include <memory>
 #include <mutex>
@@ -20,19 +21,36 @@ namespace Forwarder {
 
 class InstanceSet {
 public:
-  static std::shared_ptr<InstanceSet> Set(KafkaW::BrokerSettings Settings);
+  /// \param ProducersPerBroker Number of producers used for each broker, only
+  /// used when the instance set is created.
+  static std::shared_ptr<InstanceSet> Set(KafkaW::BrokerSettings Settings,
+                                          size_t ProducersPerBroker = 1);
   static void clear();
-  KafkaW::ProducerTopic SetUpProducerTopic(URI uri);
-  int poll();
+  /// \param KafkaSettings librdkafka properties for this topic. Topic level
+  /// properties are set on the topic, producer level properties like
+  /// linger.ms get a producer of their own which is shared by all topics
+  /// with the same settings on that broker.  The topic is given to the
+  /// producer of the broker with the shortest output queue.
+  KafkaW::ProducerTopic SetUpProducerTopic(
+      URI uri, std::map<std::string, std::string> const &KafkaSettings = {});
   void log_stats();
   std::vector<KafkaW::ProducerStats> getStatsForAllProducers();
   InstanceSet(InstanceSet const &&) = delete;
 
 private:
-  explicit InstanceSet(KafkaW::BrokerSettings opt);
+  InstanceSet(KafkaW::BrokerSettings opt, size_t ProducersPerBroker);
   std::unique_lock<std::mutex> getProducersByHostMutexLock();
+  static std::shared_ptr<KafkaW::Producer> leastLoadedProducer(
+      std::vector<std::shared_ptr<KafkaW::Producer>> const &Producers);
   KafkaW::BrokerSettings BrokerSettings;
+  size_t ProducersPerBroker;
   std::mutex ProducersByHostMutex;
-  std::map<std::string, std::shared_ptr<KafkaW::Producer>> ProducersByHost;
+  std::map<std::string, std::vector<std::shared_ptr<KafkaW::Producer>>>
+      ProducersByHost;
+  /// Producers which are being started outside of the lock, by the same key
+  /// as ProducersByHost.
+  std::map<std::string, size_t> NumProducersStarting;
+  /// Notified when a producer has been started or failed to start.
+  std::condition_variable ProducerStarted;
 };
 } // namespace Forwarder
@@ -4,11 +4,37 @@
 
 namespace Forwarder {
 
+/// Conversion pauses while the backlog is not empty, so it only has to hold
+/// the updates which were already handed to the conversion workers.
+size_t const KafkaOutput::MaxBacklog = 4096;
+
+/// Returns a message which is not sent to its owner.
+static void releaseMessage(std::unique_ptr<KafkaW::ProducerMessage> Msg) {
+  Msg.release()->release();
+}
+
 KafkaOutput::KafkaOutput(KafkaOutput &&x) noexcept
-    : Output(std::move(x.Output)) {}
+    : Output(std::move(x.Output)), Key(std::move(x.Key)) {
+  std::lock_guard<std::mutex> Lock(x.BacklogMutex);
+  Backlog = std::move(x.Backlog);
+  BacklogSize = Backlog.size();
+  x.BacklogSize = 0;
+  NumRetried = x.NumRetried.load();
+  NumDropped = x.NumDropped.load();
+}
+
+KafkaOutput::KafkaOutput(KafkaW::ProducerTopic &&OutputTopic, std::string Key)
+    : Output(std::move(OutputTopic)), Key(std::move(Key)) {}
 
-KafkaOutput::KafkaOutput(KafkaW::ProducerTopic &&OutputTopic)
-    : Output(std::move(OutputTopic)) {}
+KafkaOutput::~KafkaOutput() {
+  if (!Backlog.empty()) {
+    LOG(Sev::Warning, "Dropping {} unsent messages for topic {}",
+        Backlog.size(), Output.name());
+  }
+  for (auto &Msg : Backlog) {
+    releaseMessage(std::move(Msg));
+  }
+}
 
 int KafkaOutput::emit(std::unique_ptr<FlatBufs::FlatbufferMessage> fb) {
   if (!fb) {
@@ -19,13 +45,68 @@ int KafkaOutput::emit(std::unique_ptr<FlatBufs::FlatbufferMessage> fb) {
   fb->data = m1.data;
   fb->size = m1.size;
   std::unique_ptr<KafkaW::ProducerMessage> msg(fb.release());
-  auto x = Output.produce(msg);
+  if (BacklogSize.load() == 0) {
+    auto x = produce(msg);
+    if (x != KafkaW::ProduceQueueFull) {
+      return x;
+    }
+  }
+  std::lock_guard<std::mutex> Lock(BacklogMutex);
+  // Keep the order, newer messages have to wait for the backlog
+  sendBacklog();
+  if (Backlog.empty()) {
+    auto x = produce(msg);
+    if (x != KafkaW::ProduceQueueFull) {
+      return x;
+    }
+    LOG(Sev::Warning, "Kafka queue full, holding back messages for topic {}",
+        Output.name());
+  }
+  if (Backlog.size() >= MaxBacklog) {
+    releaseMessage(std::move(Backlog.front()));
+    Backlog.pop_front();
+    ++NumDropped;
+  }
+  Backlog.push_back(std::move(msg));
+  BacklogSize = Backlog.size();
+  return KafkaW::ProduceQueueFull;
+}
+
+bool KafkaOutput::retryBacklog() {
+  if (BacklogSize.load() == 0) {
+    return true;
+  }
+  std::lock_guard<std::mutex> Lock(BacklogMutex);
+  sendBacklog();
+  return Backlog.empty();
+}
+
+int KafkaOutput::produce(std::unique_ptr<KafkaW::ProducerMessage> &Msg) {
+  auto Size = Msg->size;
+  auto x = Output.produce(Msg, Key);
   if (x == 0) {
     ++g__total_msgs_to_kafka;
-    g__total_bytes_to_kafka += m1.size;
+    g__total_bytes_to_kafka += Size;
+  } else if (x != KafkaW::ProduceQueueFull) {
+    ++NumDropped;
+    releaseMessage(std::move(Msg));
   }
   return x;
 }
 
+void KafkaOutput::sendBacklog() {
+  while (!Backlog.empty()) {
+    auto x = produce(Backlog.front());
+    if (x == KafkaW::ProduceQueueFull) {
+      break;
+    }
+    if (x == 0) {
+      ++NumRetried;
+    }
+    Backlog.pop_front();
+  }
+  BacklogSize = Backlog.size();
+}
+
 std::string KafkaOutput::topic_name() { return Output.name(); }
 } // namespace Forwarder
@@ -2,7 +2,10 @@
 
 #include "FlatbufferMessage.h"
 #include "KafkaW/KafkaW.h"
+#include <atomic>
+#include <deque>
 #include <memory>
+#include <mutex>
 
 namespace Forwarder {
 
@@ -10,10 +13,46 @@ namespace Forwarder {
 class KafkaOutput {
 public:
   KafkaOutput(KafkaOutput &&) noexcept;
-  explicit KafkaOutput(KafkaW::ProducerTopic &&OutputTopic);
-  /// Hands off the message to Kafka
+  /// \param Key Key of all messages, e.g. the channel name.  The partitioner
+  /// of librdkafka maps a non-empty key to the same partition every time, so
+  /// that the updates of a PV stay in order.
+  explicit KafkaOutput(KafkaW::ProducerTopic &&OutputTopic,
+                       std::string Key = "");
+  ~KafkaOutput();
+  /// Hands off the message to Kafka.
+  ///
+  /// Messages which do not fit into the queue of librdkafka are kept in a
+  /// bounded backlog, which is sent before any newer message.
+  ///
+  /// \return 0 on success, KafkaW::ProduceQueueFull if the message was put
+  /// into the backlog, otherwise the message is lost.
   int emit(std::unique_ptr<FlatBufs::FlatbufferMessage> fb);
+  /// Tries to send the messages in the backlog.
+  ///
+  /// \return True if the backlog is empty.
+  bool retryBacklog();
   std::string topic_name();
+  size_t getBacklogSize() const { return BacklogSize.load(); }
+  uint64_t getNumRetried() const { return NumRetried.load(); }
+  uint64_t getNumDropped() const { return NumDropped.load(); }
   KafkaW::ProducerTopic Output;
+  std::string Key;
+  /// Upper limit of messages held back while the queue of librdkafka is full.
+  static size_t const MaxBacklog;
+
+private:
+  /// Produces the message and counts it, must be called with BacklogMutex
+  /// held if the message is from the backlog.
+  int produce(std::unique_ptr<KafkaW::ProducerMessage> &Msg);
+  /// Sends the backlog, must be called with BacklogMutex held.
+  void sendBacklog();
+  std::mutex BacklogMutex;
+  std::deque<std::unique_ptr<KafkaW::ProducerMessage>> Backlog;
+  std::atomic<size_t> BacklogSize{0};
+  /// Messages which went to the backlog and were sent later.
+  std::atomic<uint64_t> NumRetried{0};
+  /// Messages which were lost because the backlog was full or producing
+  /// failed for another reason.
+  std::atomic<uint64_t> NumDropped{0};
 };
 } // namespace Forwarder
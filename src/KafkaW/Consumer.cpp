@@ -104,16 +104,19 @@ std::unique_ptr<ConsumerMessage> Consumer::poll() {
   auto KafkaMsg = std::unique_ptr<RdKafka::Message>(
       KafkaConsumer->consume(ConsumerBrokerSettings.PollTimeoutMS));
   switch (KafkaMsg->err()) {
-  case RdKafka::ERR_NO_ERROR:
-    if (KafkaMsg->len() > 0) {
-      std::string MessageString = {
-          reinterpret_cast<const char *>(KafkaMsg->payload())};
+  case RdKafka::ERR_NO_ERROR: {
+    auto Length = KafkaMsg->len();
+    if (Length > 0) {
+      // The payload is not null-terminated
+      std::string MessageString(
+          reinterpret_cast<const char *>(KafkaMsg->payload()), Length);
       auto Message =
           ::make_unique<ConsumerMessage>(MessageString, PollStatus::Message);
       return Message;
     } else {
       return ::make_unique<ConsumerMessage>(PollStatus::Empty);
     }
+  }
   case RdKafka::ERR__PARTITION_EOF:
     return ::make_unique<ConsumerMessage>(PollStatus::EndOfPartition);
   default:
@@ -7,6 +7,7 @@ static std::atomic<int> ProducerInstanceCount;
 
 Producer::~Producer() {
   LOG(Sev::Debug, "~Producer");
+  stopPollThread();
   if (ProducerPtr != nullptr) {
     int TimeoutMS = 100;
     int NumberOfIterations = 80;
@@ -63,6 +64,25 @@ void Producer::poll() {
   Stats.out_queue = outputQueueLength();
 }
 
+void Producer::startPollThread(int TimeoutMS) {
+  if (PollThreadRun.exchange(true)) {
+    return;
+  }
+  PollThread = std::thread([this, TimeoutMS] {
+    while (PollThreadRun.load()) {
+      Stats.poll_served += ProducerPtr->poll(TimeoutMS);
+      Stats.out_queue = outputQueueLength();
+    }
+  });
+}
+
+void Producer::stopPollThread() {
+  PollThreadRun = false;
+  if (PollThread.joinable()) {
+    PollThread.join();
+  }
+}
+
 RdKafka::Producer *Producer::getRdKafkaPtr() const {
   return dynamic_cast<RdKafka::Producer *>(ProducerPtr.get());
 }
@@ -7,6 +7,7 @@
 #include "ProducerStats.h"
 #include <atomic>
 #include <functional>
+#include <thread>
 
 namespace KafkaW {
 
@@ -33,6 +34,12 @@ public:
   /// Polls Kafka for events.
   void poll() override;
 
+  /// Starts a thread which polls until the producer is destroyed, so that
+  /// delivery reports are served as soon as they arrive.
+  ///
+  /// \param TimeoutMS How long a single poll blocks.
+  void startPollThread(int TimeoutMS);
+
   /// Gets the number of messages not send.
   ///
   /// \return The number of messages.
@@ -57,13 +64,18 @@ public:
                              size_t KeySize, void *OpaqueMessage);
   BrokerSettings ProducerBrokerSettings;
   std::atomic<uint64_t> TotalMessagesProduced{0};
+  /// Number of ProducerTopics which use this producer.
+  std::atomic<size_t> NumTopics{0};
 
 protected:
   int ProducerID = 0;
   std::unique_ptr<RdKafka::Handle> ProducerPtr = nullptr;
 
 private:
+  void stopPollThread();
   std::unique_ptr<RdKafka::Conf> Conf;
+  std::atomic<bool> PollThreadRun{false};
+  std::thread PollThread;
   ProducerDeliveryCb DeliveryCb{Stats};
   KafkaEventCb EventCb;
 };
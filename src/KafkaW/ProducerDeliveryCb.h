@@ -24,8 +24,13 @@ public:
     }
     // When produce was called, we gave RdKafka a pointer to our message object
     // This is returned to us here via Message.msg_opaque() so that we can now
-    // clean it up
-    delete reinterpret_cast<ProducerMessage *>(Message.msg_opaque());
+    // clean it up or recycle it
+    auto Msg = reinterpret_cast<ProducerMessage *>(Message.msg_opaque());
+    if (Msg->ProduceTime.time_since_epoch().count() != 0) {
+      Stats.delivery_latency.add(std::chrono::steady_clock::now() -
+                                 Msg->ProduceTime);
+    }
+    Msg->release();
   }
 
 private:
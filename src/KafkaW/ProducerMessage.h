@@ -1,10 +1,16 @@
 #pragma once
+#include <chrono>
 #include <stdint.h>
 
 namespace KafkaW {
 struct ProducerMessage {
   virtual ~ProducerMessage() = default;
+  /// Called from the delivery report callback once the message is no longer
+  /// needed.  Deletes the message unless a subclass recycles it.
+  virtual void release() { delete this; }
   unsigned char *data;
   uint32_t size;
+  /// When the message was handed to librdkafka.
+  std::chrono::steady_clock::time_point ProduceTime;
 };
 }
@@ -1,7 +1,40 @@
 #pragma once
+#include <array>
 #include <atomic>
+#include <chrono>
+#include <cstdint>
 namespace KafkaW {
 
+/// Counts latencies in buckets: bucket i holds latencies below 2^i ms, the
+/// last bucket all longer ones.
+struct LatencyHistogram {
+  static constexpr size_t NumBuckets = 14;
+  std::array<std::atomic<uint64_t>, NumBuckets> Counts;
+  LatencyHistogram() {
+    for (auto &Count : Counts) {
+      Count = 0;
+    }
+  }
+  LatencyHistogram(LatencyHistogram const &x) {
+    for (size_t i = 0; i < Counts.size(); ++i) {
+      Counts[i] = x.Counts[i].load();
+    }
+  }
+  void add(std::chrono::nanoseconds Latency) {
+    auto Micros =
+        std::chrono::duration_cast<std::chrono::microseconds>(Latency).count();
+    size_t Bucket = 0;
+    while (Bucket + 1 < Counts.size() && Micros >= (int64_t(1000) << Bucket)) {
+      ++Bucket;
+    }
+    ++Counts[Bucket];
+  }
+  /// \return The upper bound of the bucket in ms, 0 for the last bucket.
+  static uint64_t upperBoundMS(size_t Bucket) {
+    return Bucket + 1 < NumBuckets ? uint64_t(1) << Bucket : 0;
+  }
+};
+
 // Provides statistics for all producers
 struct ProducerStats {
   std::atomic<uint64_t> produced{0};
@@ -13,8 +46,10 @@ struct ProducerStats {
   std::atomic<uint64_t> msg_too_large{0};
   std::atomic<uint64_t> produced_bytes{0};
   std::atomic<uint32_t> out_queue{0};
+  /// Time from handing a message to librdkafka until its delivery report.
+  LatencyHistogram delivery_latency;
   ProducerStats() = default;
-  ProducerStats(ProducerStats const &x) {
+  ProducerStats(ProducerStats const &x) : delivery_latency(x.delivery_latency) {
     produced = x.produced.load();
     produce_fail = x.produce_fail.load();
     local_queue_full = x.local_queue_full.load();
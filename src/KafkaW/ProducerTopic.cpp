@@ -4,19 +4,37 @@
 
 namespace KafkaW {
 
-ProducerTopic::ProducerTopic(std::shared_ptr<Producer> ProducerPtr,
-                             std::string TopicName)
+ProducerTopic::ProducerTopic(
+    std::shared_ptr<Producer> ProducerPtr, std::string TopicName,
+    std::map<std::string, std::string> const &TopicConfiguration)
     : KafkaProducer(ProducerPtr), Name(std::move(TopicName)) {
 
   std::string ErrStr;
-  auto Config = RdKafka::Conf::create(RdKafka::Conf::CONF_TOPIC);
+  std::unique_ptr<RdKafka::Conf> Config(
+      RdKafka::Conf::create(RdKafka::Conf::CONF_TOPIC));
+  for (auto const &Item : TopicConfiguration) {
+    if (Config->set(Item.first, Item.second, ErrStr) !=
+        RdKafka::Conf::CONF_OK) {
+      LOG(Sev::Error, "could not set {} = {} on Kafka topic {}: {}",
+          Item.first, Item.second, Name, ErrStr);
+      throw TopicCreationError();
+    }
+  }
   RdKafkaTopic = std::unique_ptr<RdKafka::Topic>(RdKafka::Topic::create(
-      KafkaProducer->getRdKafkaPtr(), Name, Config, ErrStr));
+      KafkaProducer->getRdKafkaPtr(), Name, Config.get(), ErrStr));
   if (RdKafkaTopic == nullptr) {
     LOG(Sev::Error, "could not create Kafka topic: {}", ErrStr);
     throw TopicCreationError();
   }
   LOG(Sev::Debug, "ctor topic: {}", RdKafkaTopic->name());
+  ++KafkaProducer->NumTopics;
+}
+
+ProducerTopic::~ProducerTopic() {
+  // Moved from topics have no producer
+  if (KafkaProducer != nullptr) {
+    --KafkaProducer->NumTopics;
+  }
 }
 
 ProducerTopic::ProducerTopic(ProducerTopic &&x) noexcept {
@@ -37,8 +55,8 @@ struct Msg_ : public ProducerMessage {
 /// NB this copies the provided data - so use only for low volume publishing
 /// \param MsgData Pointer to the data to publish
 /// \param MsgSize Size of the data to publish
-/// \return 0 if message is successfully passed to RdKafka to be published, 1
-/// otherwise
+/// \return 0 if message is successfully passed to RdKafka to be published,
+/// ProduceQueueFull if the queue of RdKafka is full, 1 otherwise
 int ProducerTopic::produce(unsigned char *MsgData, size_t MsgSize) {
   auto MsgPtr = new Msg_;
   std::copy(MsgData, MsgData + MsgSize, std::back_inserter(MsgPtr->v));
@@ -47,9 +65,11 @@ int ProducerTopic::produce(unsigned char *MsgData, size_t MsgSize) {
   return produce(Msg);
 }
 
-int ProducerTopic::produce(std::unique_ptr<ProducerMessage> &Msg) {
-  void const *key = nullptr;
-  size_t key_len = 0;
+int ProducerTopic::produce(std::unique_ptr<ProducerMessage> &Msg,
+                           std::string const &Key, int32_t Partition) {
+  // librdkafka copies the key
+  void const *key = Key.empty() ? nullptr : Key.data();
+  size_t key_len = Key.size();
   // MsgFlags = 0 means that we are responsible for cleaning up the message
   // after it has been sent
   // We do this by providing a pointer to our message object in the produce
@@ -57,10 +77,11 @@ int ProducerTopic::produce(std::unique_ptr<ProducerMessage> &Msg) {
   // point we can free the memory
   int MsgFlags = 0;
   auto &ProducerStats = KafkaProducer->Stats;
+  Msg->ProduceTime = std::chrono::steady_clock::now();
 
   switch (KafkaProducer->produce(
-      RdKafkaTopic.get(), RdKafka::Topic::PARTITION_UA, MsgFlags, Msg->data,
-      Msg->size, key, key_len, Msg.get())) {
+      RdKafkaTopic.get(), Partition, MsgFlags, Msg->data, Msg->size, key,
+      key_len, Msg.get())) {
   case RdKafka::ERR_NO_ERROR:
     ++ProducerStats.produced;
     ProducerStats.produced_bytes += static_cast<uint64_t>(Msg->size);
@@ -71,9 +92,9 @@ int ProducerTopic::produce(std::unique_ptr<ProducerMessage> &Msg) {
 
   case RdKafka::ERR__QUEUE_FULL:
     ++ProducerStats.local_queue_full;
-    LOG(Sev::Warning, "Producer queue full, outq: {}",
+    LOG(Sev::Debug, "Producer queue full, outq: {}",
         KafkaProducer->outputQueueLength());
-    break;
+    return ProduceQueueFull;
 
   case RdKafka::ERR_MSG_SIZE_TOO_LARGE:
     ++ProducerStats.msg_too_large;
@@ -3,6 +3,7 @@
 #include "Producer.h"
 #include "ProducerMessage.h"
 #include "logger.h"
+#include <map>
 #include <memory>
 #include <string>
 
@@ -13,13 +14,26 @@ public:
   TopicCreationError() : std::runtime_error("Can not create Kafka topic") {}
 };
 
+/// Returned by ProducerTopic::produce if the local queue of librdkafka is
+/// full, the message is then still owned by the caller.
+enum : int { ProduceQueueFull = 2 };
+
 class ProducerTopic {
 public:
   ProducerTopic(ProducerTopic &&) noexcept;
-  ProducerTopic(std::shared_ptr<Producer> ProducerPtr, std::string TopicName);
-  ~ProducerTopic() = default;
+  /// \param TopicConfiguration librdkafka topic properties, e.g.
+  /// compression.codec, applied on top of the defaults.
+  ProducerTopic(
+      std::shared_ptr<Producer> ProducerPtr, std::string TopicName,
+      std::map<std::string, std::string> const &TopicConfiguration = {});
+  ~ProducerTopic();
   int produce(unsigned char *MsgData, size_t MsgSize);
-  int produce(std::unique_ptr<KafkaW::ProducerMessage> &Msg);
+  /// \param Key Message key, none if empty.
+  /// \param Partition Partition to produce to, by default the partitioner of
+  /// librdkafka picks one based on the key.
+  int produce(std::unique_ptr<KafkaW::ProducerMessage> &Msg,
+              std::string const &Key = "",
+              int32_t Partition = RdKafka::Topic::PARTITION_UA);
   void enableCopy();
   std::string name() const;
   std::string brokerAddress() const;
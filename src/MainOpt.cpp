@@ -121,6 +121,9 @@ std::pair<int, std::unique_ptr<MainOpt>> parse_opt(int argc, char **argv) {
   App.add_option("--streams-json", opt.StreamsFile,
                  "Json file for streams to add")
       ->check(CLI::ExistingFile);
+  App.add_option("--state-snapshot", opt.StateSnapshotFile,
+                 "File to save the streams in and restore them from on "
+                 "startup");
   App.add_option("--kafka-gelf", opt.KafkaGELFAddress,
                  "Kafka GELF logging //broker[:port]/topic");
   App.add_option("--graylog-logger-address", opt.GraylogLoggerAddress,
@@ -150,6 +153,10 @@ std::pair<int, std::unique_ptr<MainOpt>> parse_opt(int argc, char **argv) {
   App.add_option("--conversion-worker-queue-size",
                  opt.MainSettings.ConversionWorkerQueueSize,
                  "Conversion worker queue size", true);
+  App.add_option("--producers-per-broker",
+                 opt.MainSettings.ProducersPerBroker,
+                 "Kafka producers per broker", true)
+      ->check(CLI::Range(1, 64));
   App.add_option("--main-poll-interval", opt.MainSettings.MainPollInterval,
                  "Main Poll interval", true);
   addKafkaOption(App, "-S,--kafka-config", opt.MainSettings.KafkaConfiguration,
@@ -20,6 +20,8 @@ struct MainOpt {
   std::string InfluxURI = "";
   std::string LogFilename;
   std::string StreamsFile;
+  /// File to keep the forwarded streams in across restarts.
+  std::string StateSnapshotFile;
   uint32_t PeriodMS = 0;
   uint32_t FakePVPeriodMS = 0;
   std::vector<char> Hostname;
@@ -0,0 +1,15 @@
+#pragma once
+
+namespace Forwarder {
+
+/// What a bounded PVUpdateQueue does with an update when it is full.
+enum class OverflowPolicy {
+  /// Discard the oldest queued update to make room.
+  DropOldest,
+  /// Discard the new update.
+  DropNewest,
+  /// Wait a bounded time for the conversion workers to make room, then
+  /// discard the new update.
+  Block,
+};
+} // namespace Forwarder
@@ -0,0 +1,215 @@
+#include "PVUpdateQueue.h"
+
+namespace Forwarder {
+
+std::chrono::milliseconds const PVUpdateQueue::MaxBlockTime{100};
+
+PVUpdateQueue::PVUpdateQueue(std::shared_ptr<WorkSignal> Signal,
+                             size_t Capacity, OverflowPolicy Policy,
+                             bool Coalesce)
+    : Signal(std::move(Signal)), Capacity(Capacity), Policy(Policy),
+      CoalesceMode(Coalesce) {}
+
+bool PVUpdateQueue::exchangeLatest(
+    std::shared_ptr<FlatBufs::EpicsPVUpdate> Update) {
+  if (std::atomic_exchange(&Latest, std::move(Update)) != nullptr) {
+    ++Coalesced;
+  } else if (Signal != nullptr) {
+    // Only an empty slot needs a worker to be woken up
+    Signal->notify();
+  }
+  return true;
+}
+
+size_t
+PVUpdateQueue::takeLatest(std::shared_ptr<FlatBufs::EpicsPVUpdate> *Updates,
+                          size_t Max) {
+  if (Max == 0) {
+    return 0;
+  }
+  Updates[0] = std::atomic_exchange(
+      &Latest, std::shared_ptr<FlatBufs::EpicsPVUpdate>());
+  return Updates[0] != nullptr ? 1 : 0;
+}
+
+bool PVUpdateQueue::makeRoom() {
+  if (Capacity == 0 || Queue.size_approx() < Capacity) {
+    return true;
+  }
+  std::shared_ptr<FlatBufs::EpicsPVUpdate> Discarded;
+  switch (Policy) {
+  case OverflowPolicy::DropOldest:
+    while (Queue.size_approx() >= Capacity && Queue.try_dequeue(Discarded)) {
+      ++DroppedOldest;
+    }
+    return true;
+  case OverflowPolicy::DropNewest:
+    ++DroppedNewest;
+    return false;
+  case OverflowPolicy::Block: {
+    ++Blocked;
+    if (Signal != nullptr) {
+      // Make sure a worker is looking at this queue
+      Signal->notify();
+    }
+    std::unique_lock<std::mutex> Lock(RoomMutex);
+    ++NumWaiting;
+    // Bounded, a missed notification only delays the producer
+    bool HasRoom = RoomAvailable.wait_for(Lock, MaxBlockTime, [this]() {
+      return Closed || Queue.size_approx() < Capacity;
+    });
+    --NumWaiting;
+    if (Closed) {
+      return false;
+    }
+    if (!HasRoom) {
+      ++DroppedNewest;
+      return false;
+    }
+    return true;
+  }
+  }
+  return true;
+}
+
+bool PVUpdateQueue::enqueue(std::shared_ptr<FlatBufs::EpicsPVUpdate> Update) {
+  if (CoalesceMode) {
+    return exchangeLatest(std::move(Update));
+  }
+  if (!makeRoom() || !Queue.enqueue(std::move(Update))) {
+    return false;
+  }
+  if (Signal != nullptr) {
+    Signal->notify();
+  }
+  return true;
+}
+
+bool PVUpdateQueue::enqueue(moodycamel::ProducerToken &Token,
+                            std::shared_ptr<FlatBufs::EpicsPVUpdate> Update) {
+  if (CoalesceMode) {
+    return exchangeLatest(std::move(Update));
+  }
+  if (!makeRoom() || !Queue.enqueue(Token, std::move(Update))) {
+    return false;
+  }
+  if (Signal != nullptr) {
+    Signal->notify();
+  }
+  return true;
+}
+
+bool PVUpdateQueue::enqueueBulk(
+    moodycamel::ProducerToken &Token,
+    std::vector<std::shared_ptr<FlatBufs::EpicsPVUpdate>> const &Updates) {
+  if (Updates.empty()) {
+    return true;
+  }
+  if (CoalesceMode) {
+    Coalesced += Updates.size() - 1;
+    return exchangeLatest(Updates.back());
+  }
+  if (Capacity > 0) {
+    // The policy has to be applied to each update
+    bool Success = true;
+    for (auto const &Update : Updates) {
+      Success = enqueue(Token, Update) && Success;
+    }
+    return Success;
+  }
+  if (!Queue.enqueue_bulk(Token, Updates.begin(), Updates.size())) {
+    return false;
+  }
+  if (Signal != nullptr) {
+    Signal->notify();
+  }
+  return true;
+}
+
+moodycamel::ProducerToken PVUpdateQueue::createProducerToken() {
+  return moodycamel::ProducerToken(Queue);
+}
+
+moodycamel::ConsumerToken PVUpdateQueue::createConsumerToken() {
+  return moodycamel::ConsumerToken(Queue);
+}
+
+bool PVUpdateQueue::tryDequeue(
+    std::shared_ptr<FlatBufs::EpicsPVUpdate> &Update) {
+  if (CoalesceMode) {
+    return takeLatest(&Update, 1) == 1;
+  }
+  auto Dequeued = Queue.try_dequeue(Update);
+  notifyRoom(Dequeued ? 1 : 0);
+  return Dequeued;
+}
+
+size_t
+PVUpdateQueue::tryDequeueBulk(std::shared_ptr<FlatBufs::EpicsPVUpdate> *Updates,
+                              size_t Max) {
+  if (CoalesceMode) {
+    return takeLatest(Updates, Max);
+  }
+  auto Dequeued = Queue.try_dequeue_bulk(Updates, Max);
+  notifyRoom(Dequeued);
+  return Dequeued;
+}
+
+size_t
+PVUpdateQueue::tryDequeueBulk(moodycamel::ConsumerToken &Token,
+                              std::shared_ptr<FlatBufs::EpicsPVUpdate> *Updates,
+                              size_t Max) {
+  if (CoalesceMode) {
+    return takeLatest(Updates, Max);
+  }
+  auto Dequeued = Queue.try_dequeue_bulk(Token, Updates, Max);
+  notifyRoom(Dequeued);
+  return Dequeued;
+}
+
+void PVUpdateQueue::notifyRoom(size_t NumDequeued) {
+  if (NumDequeued > 0 && NumWaiting > 0) {
+    std::lock_guard<std::mutex> Lock(RoomMutex);
+    RoomAvailable.notify_all();
+  }
+}
+
+size_t PVUpdateQueue::sizeApprox() const {
+  if (CoalesceMode) {
+    return std::atomic_load(&Latest) != nullptr ? 1 : 0;
+  }
+  return Queue.size_approx();
+}
+
+void PVUpdateQueue::close() {
+  Closed = true;
+  std::lock_guard<std::mutex> Lock(RoomMutex);
+  RoomAvailable.notify_all();
+}
+
+static char const *policyName(OverflowPolicy Policy) {
+  switch (Policy) {
+  case OverflowPolicy::DropOldest:
+    return "drop_oldest";
+  case OverflowPolicy::DropNewest:
+    return "drop_newest";
+  case OverflowPolicy::Block:
+    return "block";
+  }
+  return "";
+}
+
+nlohmann::json PVUpdateQueue::getStatusJson() const {
+  auto Document = nlohmann::json::object();
+  Document["capacity"] = Capacity;
+  Document["coalesce"] = CoalesceMode;
+  if (Capacity > 0 && !CoalesceMode) {
+    Document["overflow_policy"] = policyName(Policy);
+  }
+  Document["dropped_oldest"] = DroppedOldest.load();
+  Document["dropped_newest"] = DroppedNewest.load();
+  Document["coalesced"] = Coalesced.load();
+  Document["blocked"] = Blocked.load();
+  return Document;
+}
+} // namespace Forwarder
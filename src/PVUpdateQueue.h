@@ -0,0 +1,141 @@
+#pragma once
+
+#include "EpicsPVUpdate.h"
+#include "OverflowPolicy.h"
+#include "WorkSignal.h"
+#include <atomic>
+#include <chrono>
+#include <concurrentqueue/concurrentqueue.h>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <nlohmann/json.hpp>
+#include <vector>
+
+namespace Forwarder {
+
+/// Queue of PV updates from the EPICS client of a Stream to the conversion
+/// workers.
+///
+/// Every successful enqueue notifies the WorkSignal so that an idle
+/// conversion worker picks up the update right away.
+///
+/// The queue can be bounded, in which case the OverflowPolicy decides what
+/// happens to updates when it is full.  The bound is checked against the
+/// approximate size and can be exceeded by the number of concurrent producers.
+///
+/// In coalesce mode the queue is replaced by a single slot which every new
+/// update overwrites, consumers only ever see the latest value.
+class PVUpdateQueue {
+public:
+  /// \param Signal Notified on enqueue, may be nullptr.
+  /// \param Capacity Maximum number of queued updates, 0 for unbounded.
+  /// \param Policy What to do when the queue is full.
+  /// \param Coalesce Only keep the latest update, Capacity and Policy are
+  /// ignored.
+  explicit PVUpdateQueue(std::shared_ptr<WorkSignal> Signal = nullptr,
+                         size_t Capacity = 0,
+                         OverflowPolicy Policy = OverflowPolicy::DropOldest,
+                         bool Coalesce = false);
+
+  /// Adds an update to the queue.
+  ///
+  /// \param Update The PV update.
+  /// \return True if the update was queued.
+  bool enqueue(std::shared_ptr<FlatBufs::EpicsPVUpdate> Update);
+
+  /// Adds an update to the queue through an explicit producer.
+  ///
+  /// Cheaper than enqueue() without token, which has to look up the implicit
+  /// producer of the calling thread first.
+  ///
+  /// \param Token Producer token of this queue, must not be used concurrently.
+  /// \param Update The PV update.
+  /// \return True if the update was queued.
+  bool enqueue(moodycamel::ProducerToken &Token,
+               std::shared_ptr<FlatBufs::EpicsPVUpdate> Update);
+
+  /// Adds several updates to the queue in one go.
+  ///
+  /// \param Token Producer token of this queue, must not be used concurrently.
+  /// \param Updates The PV updates.
+  /// \return True if the updates were queued.
+  bool enqueueBulk(
+      moodycamel::ProducerToken &Token,
+      std::vector<std::shared_ptr<FlatBufs::EpicsPVUpdate>> const &Updates);
+
+  /// \return A new producer token, one per producing thread.
+  moodycamel::ProducerToken createProducerToken();
+
+  /// \return A new consumer token.
+  moodycamel::ConsumerToken createConsumerToken();
+
+  /// Takes the next update from the queue.
+  ///
+  /// \param Update Set to the update if one was available.
+  /// \return True if an update was taken.
+  bool tryDequeue(std::shared_ptr<FlatBufs::EpicsPVUpdate> &Update);
+
+  /// Takes up to Max updates from the queue.
+  ///
+  /// \param Updates Array of at least Max elements to move the updates to.
+  /// \param Max Maximum number of updates to take.
+  /// \return The number of updates taken.
+  size_t tryDequeueBulk(std::shared_ptr<FlatBufs::EpicsPVUpdate> *Updates,
+                        size_t Max);
+
+  /// Same as above, through a consumer token which must not be used
+  /// concurrently.
+  size_t tryDequeueBulk(moodycamel::ConsumerToken &Token,
+                        std::shared_ptr<FlatBufs::EpicsPVUpdate> *Updates,
+                        size_t Max);
+
+  /// \return The approximate number of queued updates.
+  size_t sizeApprox() const;
+
+  /// Stops producers from waiting for room in the queue, called when the
+  /// updates will not be consumed any longer.
+  void close();
+
+  /// \return Capacity, policy and overflow counters.
+  nlohmann::json getStatusJson() const;
+
+  /// How long a producer waits for room with OverflowPolicy::Block.  The
+  /// producer is usually the EPICS callback thread, which serves other
+  /// channels as well.
+  static std::chrono::milliseconds const MaxBlockTime;
+
+private:
+  /// Applies the overflow policy if the queue is full.
+  ///
+  /// \return False if the new update has to be dropped.
+  bool makeRoom();
+
+  /// Wakes up producers waiting for room, called after a dequeue.
+  void notifyRoom(size_t NumDequeued);
+
+  /// Puts the update into the single slot of coalesce mode.
+  bool exchangeLatest(std::shared_ptr<FlatBufs::EpicsPVUpdate> Update);
+
+  /// Takes the update from the single slot of coalesce mode.
+  size_t takeLatest(std::shared_ptr<FlatBufs::EpicsPVUpdate> *Updates,
+                    size_t Max);
+
+  moodycamel::ConcurrentQueue<std::shared_ptr<FlatBufs::EpicsPVUpdate>> Queue;
+  std::shared_ptr<WorkSignal> Signal;
+  size_t Capacity;
+  OverflowPolicy Policy;
+  bool CoalesceMode;
+  /// The pending update in coalesce mode, only accessed atomically.
+  std::shared_ptr<FlatBufs::EpicsPVUpdate> Latest;
+  std::atomic<bool> Closed{false};
+  /// Producers wait here with OverflowPolicy::Block.
+  std::mutex RoomMutex;
+  std::condition_variable RoomAvailable;
+  std::atomic<uint32_t> NumWaiting{0};
+  std::atomic<uint64_t> DroppedOldest{0};
+  std::atomic<uint64_t> DroppedNewest{0};
+  std::atomic<uint64_t> Coalesced{0};
+  std::atomic<uint64_t> Blocked{0};
+};
+} // namespace Forwarder
@@ -0,0 +1,253 @@
+#include "StateSnapshot.h"
+#include "logger.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#ifndef _WIN32
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#include <windows.h>
+#endif
+
+namespace Forwarder {
+
+static char const SnapshotMagic[8] = {'F', 'W', 'D', 'S', 'N', 'A', 'P', '1'};
+
+namespace {
+
+class Writer {
+public:
+  explicit Writer(std::vector<char> &Buffer) : Buffer(Buffer) {}
+  template <typename T> void put(T Value) {
+    auto Bytes = reinterpret_cast<char const *>(&Value);
+    Buffer.insert(Buffer.end(), Bytes, Bytes + sizeof(T));
+  }
+  void putString(std::string const &String) {
+    put(static_cast<uint32_t>(String.size()));
+    Buffer.insert(Buffer.end(), String.begin(), String.end());
+  }
+  void putMap(std::map<std::string, std::string> const &Map) {
+    put(static_cast<uint32_t>(Map.size()));
+    for (auto const &Item : Map) {
+      putString(Item.first);
+      putString(Item.second);
+    }
+  }
+
+private:
+  std::vector<char> &Buffer;
+};
+
+class Reader {
+public:
+  Reader(char const *Data, size_t Size) : Data(Data), Size(Size) {}
+  template <typename T> T get() {
+    T Value;
+    std::memcpy(&Value, take(sizeof(T)), sizeof(T));
+    return Value;
+  }
+  std::string getString() {
+    auto Length = get<uint32_t>();
+    return std::string(take(Length), Length);
+  }
+  /// Reads a number of items, each takes at least one byte.
+  uint32_t getCount() {
+    auto Count = get<uint32_t>();
+    if (Count > Size - Position) {
+      throw std::runtime_error("Snapshot is corrupt");
+    }
+    return Count;
+  }
+  std::map<std::string, std::string> getMap() {
+    std::map<std::string, std::string> Map;
+    auto Count = getCount();
+    for (uint32_t i = 0; i < Count; ++i) {
+      auto Key = getString();
+      Map[Key] = getString();
+    }
+    return Map;
+  }
+  char const *take(size_t Length) {
+    if (Length > Size - Position) {
+      throw std::runtime_error("Snapshot is truncated");
+    }
+    auto Pointer = Data + Position;
+    Position += Length;
+    return Pointer;
+  }
+
+private:
+  char const *Data;
+  size_t Size;
+  size_t Position = 0;
+};
+} // namespace
+
+std::vector<char>
+StateSnapshot::serialize(std::vector<StreamSettings> const &Streams) {
+  std::vector<char> Buffer(SnapshotMagic,
+                           SnapshotMagic + sizeof(SnapshotMagic));
+  Writer Out(Buffer);
+  Out.put(static_cast<uint32_t>(Streams.size()));
+  for (auto const &Stream : Streams) {
+    Out.putString(Stream.Name);
+    Out.putString(Stream.EpicsProtocol);
+    Out.put(static_cast<uint8_t>(Stream.ZeroCopy));
+    Out.put(static_cast<uint64_t>(Stream.QueueSize));
+    Out.put(static_cast<uint8_t>(Stream.Overflow));
+    Out.put(static_cast<uint8_t>(Stream.Coalesce));
+    Out.put(Stream.Filter.DeadbandAbsolute);
+    Out.put(Stream.Filter.DeadbandRelative);
+    Out.put(Stream.Filter.MinIntervalMS);
+    Out.put(static_cast<uint32_t>(Stream.Converters.size()));
+    for (auto const &Converter : Stream.Converters) {
+      Out.putString(Converter.Schema);
+      Out.putString(Converter.Topic);
+      Out.putString(Converter.Name);
+      Out.putMap(Converter.Config);
+      Out.putMap(Converter.Kafka);
+    }
+  }
+  return Buffer;
+}
+
+std::vector<StreamSettings> StateSnapshot::deserialize(char const *Data,
+                                                       size_t Size) {
+  Reader In(Data, Size);
+  if (std::memcmp(In.take(sizeof(SnapshotMagic)), SnapshotMagic,
+                  sizeof(SnapshotMagic)) != 0) {
+    throw std::runtime_error("Not a snapshot of this version");
+  }
+  std::vector<StreamSettings> Streams(In.getCount());
+  for (auto &Stream : Streams) {
+    Stream.Name = In.getString();
+    Stream.EpicsProtocol = In.getString();
+    Stream.ZeroCopy = In.get<uint8_t>() != 0;
+    Stream.QueueSize = static_cast<size_t>(In.get<uint64_t>());
+    auto Overflow = In.get<uint8_t>();
+    if (Overflow > static_cast<uint8_t>(OverflowPolicy::Block)) {
+      throw std::runtime_error("Invalid overflow policy in snapshot");
+    }
+    Stream.Overflow = static_cast<OverflowPolicy>(Overflow);
+    Stream.Coalesce = In.get<uint8_t>() != 0;
+    Stream.Filter.DeadbandAbsolute = In.get<double>();
+    Stream.Filter.DeadbandRelative = In.get<double>();
+    Stream.Filter.MinIntervalMS = In.get<uint64_t>();
+    Stream.Converters.resize(In.getCount());
+    for (auto &Converter : Stream.Converters) {
+      Converter.Schema = In.getString();
+      Converter.Topic = In.getString();
+      Converter.Name = In.getString();
+      Converter.Config = In.getMap();
+      Converter.Kafka = In.getMap();
+    }
+  }
+  return Streams;
+}
+
+bool StateSnapshot::writeFile(std::string const &Filename,
+                              std::vector<char> const &Image) {
+  auto TemporaryFilename = Filename + ".tmp";
+#ifndef _WIN32
+  int FileDescriptor =
+      open(TemporaryFilename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (FileDescriptor < 0) {
+    LOG(Sev::Error, "Can not create state snapshot {}", TemporaryFilename);
+    return false;
+  }
+  size_t Written = 0;
+  while (Written < Image.size()) {
+    auto Result = write(FileDescriptor, Image.data() + Written,
+                        Image.size() - Written);
+    if (Result < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      break;
+    }
+    Written += static_cast<size_t>(Result);
+  }
+  // The data has to be on disk before the rename, otherwise a crash can
+  // leave an empty snapshot behind
+  bool Synced = Written == Image.size() && fsync(FileDescriptor) == 0;
+  if (close(FileDescriptor) != 0 || !Synced) {
+    LOG(Sev::Error, "Can not write state snapshot {}", TemporaryFilename);
+    return false;
+  }
+  // Replaces the old snapshot atomically
+  if (std::rename(TemporaryFilename.c_str(), Filename.c_str()) != 0) {
+    LOG(Sev::Error, "Can not replace state snapshot {}", Filename);
+    return false;
+  }
+#else
+  {
+    std::ofstream File(TemporaryFilename, std::ios::binary | std::ios::trunc);
+    File.write(Image.data(), Image.size());
+    if (!File) {
+      LOG(Sev::Error, "Can not write state snapshot {}", TemporaryFilename);
+      return false;
+    }
+  }
+  if (!MoveFileExA(TemporaryFilename.c_str(), Filename.c_str(),
+                   MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH)) {
+    LOG(Sev::Error, "Can not replace state snapshot {}", Filename);
+    return false;
+  }
+#endif
+  return true;
+}
+
+std::vector<StreamSettings>
+StateSnapshot::readFile(std::string const &Filename) {
+  try {
+#ifndef _WIN32
+    int FileDescriptor = open(Filename.c_str(), O_RDONLY);
+    if (FileDescriptor < 0) {
+      LOG(Sev::Info, "No state snapshot {} to restore", Filename);
+      return {};
+    }
+    struct stat FileStatus;
+    if (fstat(FileDescriptor, &FileStatus) != 0 || FileStatus.st_size == 0) {
+      close(FileDescriptor);
+      return {};
+    }
+    auto Size = static_cast<size_t>(FileStatus.st_size);
+    auto Mapped =
+        mmap(nullptr, Size, PROT_READ, MAP_PRIVATE, FileDescriptor, 0);
+    close(FileDescriptor);
+    if (Mapped == MAP_FAILED) {
+      LOG(Sev::Error, "Can not map state snapshot {}", Filename);
+      return {};
+    }
+    std::vector<StreamSettings> Streams;
+    try {
+      Streams = deserialize(static_cast<char const *>(Mapped), Size);
+    } catch (...) {
+      munmap(Mapped, Size);
+      throw;
+    }
+    munmap(Mapped, Size);
+    return Streams;
+#else
+    std::ifstream File(Filename, std::ios::binary);
+    if (!File) {
+      LOG(Sev::Info, "No state snapshot {} to restore", Filename);
+      return {};
+    }
+    std::vector<char> Image((std::istreambuf_iterator<char>(File)),
+                            std::istreambuf_iterator<char>());
+    return deserialize(Image.data(), Image.size());
+#endif
+  } catch (std::exception const &e) {
+    LOG(Sev::Error, "Can not restore state snapshot {}: {}", Filename,
+        e.what());
+  }
+  return {};
+}
+} // namespace Forwarder
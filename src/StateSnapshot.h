@@ -0,0 +1,36 @@
+#pragma once
+
+#include "ConfigParser.h"
+#include <string>
+#include <vector>
+
+namespace Forwarder {
+
+/// Compact binary image of the streams which are forwarded, so that the
+/// forwarder can restart without replaying commands and parsing JSON.
+///
+/// The file is meant to be read back by the same build on the same machine,
+/// numbers are stored in host byte order.
+class StateSnapshot {
+public:
+  /// \return The binary image of the given streams.
+  static std::vector<char>
+  serialize(std::vector<StreamSettings> const &Streams);
+
+  /// \throw std::runtime_error If the data is not a valid snapshot.
+  static std::vector<StreamSettings> deserialize(char const *Data,
+                                                 size_t Size);
+
+  /// Writes the image to a temporary file which then replaces the file, so
+  /// that a crash never leaves a partially written snapshot behind.
+  ///
+  /// \return True on success.
+  static bool writeFile(std::string const &Filename,
+                        std::vector<char> const &Image);
+
+  /// Maps the file into memory and restores the streams from it.
+  ///
+  /// \return The restored streams, empty if there is no valid snapshot.
+  static std::vector<StreamSettings> readFile(std::string const &Filename);
+};
+} // namespace Forwarder
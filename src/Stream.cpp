@@ -10,44 +10,87 @@ namespace Forwarder {
 
 ConversionPath::ConversionPath(ConversionPath &&x) noexcept
     : converter(std::move(x.converter)),
-      kafka_output(std::move(x.kafka_output)) {}
+      kafka_output(std::move(x.kafka_output)),
+      Batched(std::move(x.Batched)) {}
 
 ConversionPath::ConversionPath(std::shared_ptr<Converter> conv,
                                std::unique_ptr<KafkaOutput> ko)
     : converter(std::move(conv)), kafka_output(std::move(ko)) {}
 
+ConversionPath::ConversionPath(std::shared_ptr<Converter> Conv,
+                               std::shared_ptr<BatchedOutput> Batched)
+    : converter(std::move(Conv)), Batched(std::move(Batched)) {}
+
 ConversionPath::~ConversionPath() {
   LOG(Sev::Debug, "~ConversionPath");
-  while (true) {
-    auto x = transit.load();
-    if (x == 0)
-      break;
-    LOG(Sev::Debug, "~ConversionPath  still has transit {}", transit);
-    std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+  // Streams are only reclaimed once they have nothing in transit, so this is
+  // merely a safety net.
+  if (transit.load() != 0) {
+    LOG(Sev::Warning, "~ConversionPath  still has transit {}", transit);
+    while (transit.load() != 0) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
   }
 }
 
 int ConversionPath::emit(std::shared_ptr<FlatBufs::EpicsPVUpdate> up) {
   auto fb = converter->convert(*up);
   if (fb == nullptr) {
-    LOG(Sev::Info, "empty converted flat buffer");
+    // Either an error or held back by the converter
+    LOG(Sev::Debug, "empty converted flat buffer");
     return 1;
   }
+  if (Batched != nullptr) {
+    Batched->emit(std::move(fb));
+    return 0;
+  }
   kafka_output->emit(std::move(fb));
   return 0;
 }
 
+int ConversionPath::flush() {
+  retryBacklog();
+  return flushBatch(false);
+}
+
+int ConversionPath::flushBatch(bool Force) {
+  if (Batched == nullptr) {
+    return 0;
+  }
+  return Batched->flush(Force);
+}
+
+bool ConversionPath::hasBatch() const { return Batched != nullptr; }
+
+bool ConversionPath::retryBacklog() {
+  if (Batched != nullptr) {
+    return Batched->getOutput().retryBacklog();
+  }
+  return kafka_output == nullptr || kafka_output->retryBacklog();
+}
+
+KafkaOutput &ConversionPath::getOutput() const {
+  if (Batched != nullptr) {
+    return Batched->getOutput();
+  }
+  return *kafka_output;
+}
+
 nlohmann::json ConversionPath::status_json() const {
   using nlohmann::json;
   auto Document = json::object();
   Document["schema"] = converter->schema_name();
-  Document["broker"] = kafka_output->Output.brokerAddress();
-  Document["topic"] = kafka_output->topic_name();
+  auto &Output = getOutput();
+  Document["broker"] = Output.Output.brokerAddress();
+  Document["topic"] = Output.topic_name();
+  Document["backlog"] = Output.getBacklogSize();
+  Document["retried"] = Output.getNumRetried();
+  Document["dropped"] = Output.getNumDropped();
   return Document;
 }
 
 std::string ConversionPath::getKafkaTopicName() const {
-  return kafka_output->topic_name();
+  return getOutput().topic_name();
 }
 
 std::string ConversionPath::getSchemaName() const {
@@ -56,11 +99,10 @@ std::string ConversionPath::getSchemaName() const {
 
 Stream::Stream(
     ChannelInfo Info, std::shared_ptr<EpicsClient::EpicsClientInterface> Client,
-    std::shared_ptr<
-        moodycamel::ConcurrentQueue<std::shared_ptr<FlatBufs::EpicsPVUpdate>>>
-        Queue)
+    std::shared_ptr<PVUpdateQueue> Queue)
     : ChannelInfo_(std::move(Info)), Client(std::move(Client)),
-      OutputQueue(std::move(Queue)) {}
+      OutputQueue(std::move(Queue)),
+      OutputToken(OutputQueue->createConsumerToken()) {}
 
 Stream::~Stream() {
   LOG(Sev::Debug, "~Stream");
@@ -79,6 +121,9 @@ int Stream::addConverter(std::unique_ptr<ConversionPath> Path) {
                Path->getSchemaName() == TestPath->getSchemaName();
       });
   if (FoundPath == ConversionPaths.end()) {
+    if (Path->hasBatch()) {
+      HasBatches = true;
+    }
     ConversionPaths.push_back(std::move(Path));
     return 0;
   }
@@ -89,56 +134,117 @@ int Stream::addConverter(std::unique_ptr<ConversionPath> Path) {
   return 1;
 }
 
+void Stream::flushConversionPaths() {
+  std::lock_guard<std::mutex> lock(ConversionPathsMutex);
+  for (auto &Path : ConversionPaths) {
+    Path->flush();
+  }
+}
+
+void Stream::flushBatches() {
+  if (!HasBatches.load()) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(ConversionPathsMutex);
+  for (auto &Path : ConversionPaths) {
+    Path->flushBatch(false);
+  }
+}
+
+void Stream::setFilter(std::unique_ptr<UpdateFilter> NewFilter) {
+  std::lock_guard<std::mutex> lock(ConversionPathsMutex);
+  Filter = std::move(NewFilter);
+}
+
 void Stream::setEpicsError() { Client->errorInEpics(); }
 
-uint32_t Stream::fillConversionQueue(
-    moodycamel::ConcurrentQueue<std::unique_ptr<ConversionWorkPacket>> &Queue,
-    uint32_t max) {
-  uint32_t NumDequeued = 0;
+uint32_t Stream::getNumInTransit() {
+  std::lock_guard<std::mutex> lock(ConversionPathsMutex);
+  uint32_t NumInTransit = 0;
+  for (auto &Path : ConversionPaths) {
+    NumInTransit += Path->transit.load();
+  }
+  return NumInTransit;
+}
+
+uint32_t Stream::fillConversionQueue(ConversionWorkQueue &Queue,
+                                     uint32_t max) {
+  if (Filling.exchange(true)) {
+    // Another worker is already on it
+    return 0;
+  }
+  std::lock_guard<std::mutex> lock(ConversionPathsMutex);
+  // While Kafka can not keep up, leave the updates in our queue where its
+  // overflow policy applies instead of converting them in vain.
+  for (auto &Path : ConversionPaths) {
+    if (!Path->retryBacklog()) {
+      ++NumBackpressurePauses;
+      Filling = false;
+      return 0;
+    }
+  }
   uint32_t NumQueued = 0;
-  auto BufferSize = OutputQueue->size_approx();
   auto ConversionPathSize = ConversionPaths.size();
-  std::vector<ConversionWorkPacket *> cwp_last(ConversionPathSize);
-
-  // Add to queue if data still available and queue has enough "space" for all
-  // conversion paths for a single update.
-  while (NumDequeued < BufferSize && max - NumQueued >= ConversionPathSize) {
-    std::shared_ptr<FlatBufs::EpicsPVUpdate> EpicsUpdate;
-    auto found = OutputQueue->try_dequeue(EpicsUpdate);
-    if (!found) {
-      LOG(Sev::Info, "Conversion worker buffer is empty");
-      break;
-    }
-    NumDequeued += 1;
+
+  // Take as many updates as are available and as fit into the queue with
+  // packets for all conversion paths.
+  size_t MaxUpdates = OutputQueue->sizeApprox();
+  if (ConversionPathSize > 0) {
+    MaxUpdates = std::min<size_t>(MaxUpdates, max / ConversionPathSize);
+  }
+  if (MaxUpdates == 0) {
+    Filling = false;
+    return 0;
+  }
+  DequeueBuffer.resize(MaxUpdates);
+  auto NumDequeued = OutputQueue->tryDequeueBulk(
+      OutputToken, DequeueBuffer.data(), MaxUpdates);
+  if (NumDequeued == 0) {
+    LOG(Sev::Info, "Conversion worker buffer is empty");
+  }
+  LastPackets.resize(ConversionPathSize);
+  for (size_t i = 0; i < NumDequeued; ++i) {
+    auto &EpicsUpdate = DequeueBuffer[i];
     if (!EpicsUpdate) {
       LOG(Sev::Info, "Empty EPICS PV update");
       continue;
     }
-    size_t ConversionPathID = 0;
-    for (auto &ConversionPath : ConversionPaths) {
-      auto ConversionPacket = ::make_unique<ConversionWorkPacket>();
-      cwp_last[ConversionPathID] = ConversionPacket.get();
-      ConversionPacket->cp = ConversionPath.get();
-      ConversionPacket->up = EpicsUpdate;
-      bool QueuedSuccessful = Queue.enqueue(std::move(ConversionPacket));
-      if (!QueuedSuccessful) {
-        LOG(Sev::Info, "Conversion work queue is full");
-        break;
+    // The periodic updates would never pass a deadband or interval
+    if (Filter != nullptr && !EpicsUpdate->cached_reemit &&
+        !Filter->accept(*EpicsUpdate)) {
+      ++NumFiltered;
+      continue;
+    }
+    for (size_t ConversionPathID = 0; ConversionPathID < ConversionPathSize;
+         ++ConversionPathID) {
+      auto ConversionPacket = Queue.acquire();
+      LastPackets[ConversionPathID] = ConversionPacket;
+      ConversionPacket->cp = ConversionPaths[ConversionPathID].get();
+      // The last conversion path can take over our reference
+      if (ConversionPathID + 1 < ConversionPathSize) {
+        ConversionPacket->up = EpicsUpdate;
+      } else {
+        ConversionPacket->up = std::move(EpicsUpdate);
       }
-      ConversionPathID += 1;
+      Queue.push(ConversionPacket);
       NumQueued += 1;
     }
   }
+  // Drop any updates which had no conversion path
+  DequeueBuffer.clear();
   if (NumQueued > 0) {
     for (uint32_t i1 = 0; i1 < ConversionPathSize; ++i1) {
-      cwp_last[i1]->stream = this;
+      LastPackets[i1]->stream = this;
       ConversionPaths[i1]->transit++;
     }
   }
+  Filling = false;
   return NumQueued;
 }
 
 int Stream::stop() {
+  // Producers blocked on a full queue must not hold up the EPICS client
+  OutputQueue->close();
   if (Client != nullptr) {
     Client->stop();
   }
@@ -149,7 +255,7 @@ int Stream::status() { return Client->status(); }
 
 ChannelInfo const &Stream::getChannelInfo() const { return ChannelInfo_; }
 
-size_t Stream::getQueueSize() { return OutputQueue->size_approx(); }
+size_t Stream::getQueueSize() { return OutputQueue->sizeApprox(); }
 
 nlohmann::json Stream::getStatusJson() {
   using nlohmann::json;
@@ -157,6 +263,9 @@ nlohmann::json Stream::getStatusJson() {
   auto const &ChannelInfo = getChannelInfo();
   Document["channel_name"] = ChannelInfo.channel_name;
   Document["getQueueSize"] = getQueueSize();
+  Document["queue"] = OutputQueue->getStatusJson();
+  Document["filtered"] = NumFiltered.load();
+  Document["backpressure_pauses"] = NumBackpressurePauses.load();
   {
     std::lock_guard<std::mutex> lock(SeqDataEmitted.Mutex);
     auto const &Set = SeqDataEmitted.set;
@@ -1,16 +1,20 @@
 #pragma once
 
+#include "BatchedOutput.h"
 #include "ConversionWorker.h"
 #include "Kafka.h"
 #include "KafkaOutput.h"
+#include "PVUpdateQueue.h"
 #include "RangeSet.h"
 #include "SchemaRegistry.h"
 #include "URI.h"
+#include "UpdateFilter.h"
 #include <EpicsClient/EpicsClientInterface.h>
 #include <array>
 #include <atomic>
 #include <concurrentqueue/concurrentqueue.h>
 #include <memory>
+#include <mutex>
 #include <nlohmann/json.hpp>
 #include <string>
 #include <vector>
@@ -19,6 +23,7 @@ namespace Forwarder {
 
 class Converter;
 struct ConversionWorkPacket;
+class ConversionWorkQueue;
 
 struct ChannelInfo {
   std::string provider_type;
@@ -30,16 +35,36 @@ class ConversionPath {
 public:
   ConversionPath(ConversionPath &&x) noexcept;
   ConversionPath(std::shared_ptr<Converter>, std::unique_ptr<KafkaOutput>);
+  /// Sends the messages in batches which other paths may share.
+  ConversionPath(std::shared_ptr<Converter> Conv,
+                 std::shared_ptr<BatchedOutput> Batched);
   virtual ~ConversionPath();
-  int emit(std::shared_ptr<FlatBufs::EpicsPVUpdate> up);
+  virtual int emit(std::shared_ptr<FlatBufs::EpicsPVUpdate> up);
+  /// Retries the backlog and sends the batch if it is due.
+  virtual int flush();
+  /// Sends the batch which this path adds to.
+  ///
+  /// \param Force Send the batch even if its deadline has not passed yet.
+  /// \return 1 if a batch was sent, 0 otherwise.
+  int flushBatch(bool Force);
+  /// \return True if the converter batches the messages of this path.
+  bool hasBatch() const;
+  /// Tries to send the messages held back because Kafka could not keep up.
+  ///
+  /// \return True if nothing is held back any longer.
+  virtual bool retryBacklog();
   std::atomic<uint32_t> transit{0};
   nlohmann::json status_json() const;
   virtual std::string getKafkaTopicName() const;
   virtual std::string getSchemaName() const;
 
 private:
+  KafkaOutput &getOutput() const;
   std::shared_ptr<Converter> converter;
   std::unique_ptr<KafkaOutput> kafka_output;
+  /// Set instead of kafka_output if the converter batches its messages, the
+  /// last path using it sends the pending batch.
+  std::shared_ptr<BatchedOutput> Batched;
 };
 
 /// Represents a stream from an EPICS PV through a Converter into a KafkaOutput.
@@ -48,17 +73,24 @@ public:
   Stream(
       ChannelInfo Info,
       std::shared_ptr<EpicsClient::EpicsClientInterface> Client,
-      std::shared_ptr<
-          moodycamel::ConcurrentQueue<std::shared_ptr<FlatBufs::EpicsPVUpdate>>>
-          Queue);
+      std::shared_ptr<PVUpdateQueue> Queue);
   Stream(Stream &&) = delete;
   ~Stream();
   int addConverter(std::unique_ptr<ConversionPath> Path);
-  uint32_t fillConversionQueue(
-      moodycamel::ConcurrentQueue<std::unique_ptr<ConversionWorkPacket>> &Queue,
-      uint32_t max);
+  /// Replaces the filter which updates have to pass before conversion.
+  ///
+  /// \param Filter The new filter, nullptr to forward all updates.
+  void setFilter(std::unique_ptr<UpdateFilter> Filter);
+  /// Flushes all conversion paths.
+  void flushConversionPaths();
+  /// Sends the batches of the conversion paths which are due.
+  void flushBatches();
+  uint32_t fillConversionQueue(ConversionWorkQueue &Queue, uint32_t max);
   int stop();
   void setEpicsError();
+  /// \return Number of updates handed to conversion workers and not yet
+  /// released.
+  uint32_t getNumInTransit();
   int status();
   ChannelInfo const &getChannelInfo() const;
   std::shared_ptr<EpicsClient::EpicsClientInterface> getEpicsClient();
@@ -70,13 +102,28 @@ private:
   ChannelInfo ChannelInfo_;
   std::vector<std::unique_ptr<ConversionPath>> ConversionPaths;
   std::shared_ptr<EpicsClient::EpicsClientInterface> Client;
-  std::shared_ptr<
-      moodycamel::ConcurrentQueue<std::shared_ptr<FlatBufs::EpicsPVUpdate>>>
-      OutputQueue;
+  std::shared_ptr<PVUpdateQueue> OutputQueue;
+  /// Only used while Filling is set.
+  moodycamel::ConsumerToken OutputToken;
   RangeSet<uint64_t> SeqDataEmitted;
 
+  /// Set while a conversion worker takes updates from this stream, so that
+  /// updates are handed out in order even when workers steal from each other.
+  std::atomic<bool> Filling{false};
+  /// Reused by fillConversionQueue() to avoid allocations.
+  std::vector<std::shared_ptr<FlatBufs::EpicsPVUpdate>> DequeueBuffer;
+  std::vector<ConversionWorkPacket *> LastPackets;
+  /// Guarded by ConversionPathsMutex.
+  std::unique_ptr<UpdateFilter> Filter;
+  std::atomic<uint64_t> NumFiltered{0};
+  /// Refills skipped because a conversion path had a backlog.
+  std::atomic<uint64_t> NumBackpressurePauses{0};
+  /// Set once a conversion path with a batch has been added.
+  std::atomic<bool> HasBatches{false};
+
   /// We want to be able to add conversion paths after forwarding is running.
   /// Therefore, we need mutually exclusive access to 'conversion_paths'.
+  /// Also guards the filter.
   std::mutex ConversionPathsMutex;
 };
 } // namespace Forwarder
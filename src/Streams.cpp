@@ -8,45 +8,93 @@ size_t Streams::size() const { return StreamPointers.size(); }
 
 void Streams::stopChannel(std::string const &channel) {
   std::lock_guard<std::mutex> lock(StreamsMutex);
-  StreamPointers.erase(
-      std::remove_if(StreamPointers.begin(), StreamPointers.end(),
-                     [&](std::shared_ptr<Stream> s) {
-                       return (s->getChannelInfo().channel_name == channel);
-                     }),
-      StreamPointers.end());
+  if (StreamsByChannel.erase(channel) == 0) {
+    return;
+  }
+  auto NewEnd = std::stable_partition(
+      StreamPointers.begin(), StreamPointers.end(),
+      [&](std::shared_ptr<Stream> const &s) {
+        return s->getChannelInfo().channel_name != channel;
+      });
+  retire(NewEnd, StreamPointers.end());
+  StreamPointers.erase(NewEnd, StreamPointers.end());
+  publishSnapshot();
 }
 
 void Streams::clearStreams() {
   LOG(Sev::Debug, "Main::clearStreams()  begin");
   std::lock_guard<std::mutex> lock(StreamsMutex);
   if (!StreamPointers.empty()) {
-    for (auto const &Stream : StreamPointers) {
-      Stream->stop();
-    }
-    // Wait for Epics to cool down
-    std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+    retire(StreamPointers.begin(), StreamPointers.end());
     StreamPointers.clear();
+    StreamsByChannel.clear();
+    publishSnapshot();
   }
   LOG(Sev::Debug, "Main::clearStreams()  end");
 };
 
+void Streams::retire(StreamList::iterator Begin, StreamList::iterator End) {
+  auto Now = std::chrono::steady_clock::now();
+  std::lock_guard<std::mutex> lock(RetiredMutex);
+  for (auto It = Begin; It != End; ++It) {
+    (*It)->stop();
+    RetiredStreams.push_back({std::move(*It), Now});
+  }
+}
+
+size_t Streams::reclaimRetired(std::chrono::milliseconds GracePeriod) {
+  std::vector<std::shared_ptr<Stream>> Reclaimed;
+  size_t NumWaiting = 0;
+  {
+    std::lock_guard<std::mutex> lock(RetiredMutex);
+    if (RetiredStreams.empty()) {
+      return 0;
+    }
+    auto Now = std::chrono::steady_clock::now();
+    // Conversion workers keep the streams of their last refill until their
+    // next one, so a stream only referenced from here has no work in flight.
+    auto NewEnd = std::partition(
+        RetiredStreams.begin(), RetiredStreams.end(),
+        [&](RetiredStream const &Entry) {
+          return Entry.Retired.use_count() > 1 ||
+                 Entry.Retired->getNumInTransit() > 0 ||
+                 Now - Entry.RetiredAt < GracePeriod;
+        });
+    for (auto It = NewEnd; It != RetiredStreams.end(); ++It) {
+      Reclaimed.push_back(std::move(It->Retired));
+    }
+    RetiredStreams.erase(NewEnd, RetiredStreams.end());
+    NumWaiting = RetiredStreams.size();
+  }
+  // Destroyed without holding the lock
+  Reclaimed.clear();
+  return NumWaiting;
+}
+
 void Streams::checkStreamStatus() {
+  std::lock_guard<std::mutex> lock(StreamsMutex);
   if (StreamPointers.empty()) {
     return;
   }
-  StreamPointers.erase(std::remove_if(StreamPointers.begin(),
-                                      StreamPointers.end(),
-                                      [&](std::shared_ptr<Stream> s) {
-                                        if (s->status() < 0) {
-                                          s->stop();
-                                          return true;
-                                        }
-                                        return false;
-                                      }),
-                       StreamPointers.end());
+  auto NewEnd =
+      std::stable_partition(StreamPointers.begin(), StreamPointers.end(),
+                            [&](std::shared_ptr<Stream> const &s) {
+                              return s->status() >= 0;
+                            });
+  if (NewEnd != StreamPointers.end()) {
+    retire(NewEnd, StreamPointers.end());
+    StreamPointers.erase(NewEnd, StreamPointers.end());
+    rebuildIndex();
+    publishSnapshot();
+  }
 }
 
-void Streams::add(std::shared_ptr<Stream> s) { StreamPointers.push_back(s); }
+void Streams::add(std::shared_ptr<Stream> s) {
+  std::lock_guard<std::mutex> lock(StreamsMutex);
+  StreamsByChannel.emplace(s->getChannelInfo().channel_name, s);
+  StreamPointers.push_back(s);
+  SnapshotStale = true;
+}
 
 std::shared_ptr<Stream> Streams::back() {
   return StreamPointers.empty() ? nullptr : StreamPointers.back();
@@ -56,16 +104,38 @@ const std::vector<std::shared_ptr<Stream>> &Streams::getStreams() const {
   return StreamPointers;
 }
 
+std::shared_ptr<StreamList const> Streams::getStreamsSnapshot() {
+  if (SnapshotStale.load()) {
+    std::unique_lock<std::mutex> lock(StreamsMutex, std::try_to_lock);
+    if (lock.owns_lock() && SnapshotStale.load()) {
+      publishSnapshot();
+    }
+  }
+  return std::atomic_load(&Snapshot);
+}
+
+void Streams::publishSnapshot() {
+  std::shared_ptr<StreamList const> NewSnapshot =
+      std::make_shared<StreamList>(StreamPointers);
+  std::atomic_store(&Snapshot, NewSnapshot);
+  SnapshotStale = false;
+}
+
+void Streams::rebuildIndex() {
+  StreamsByChannel.clear();
+  for (auto const &CurrentStream : StreamPointers) {
+    StreamsByChannel.emplace(CurrentStream->getChannelInfo().channel_name,
+                             CurrentStream);
+  }
+}
+
 std::shared_ptr<Stream>
 Streams::getStreamByChannelName(std::string const &channel_name) {
-  auto FoundChannel = std::find_if(
-      StreamPointers.cbegin(), StreamPointers.cend(),
-      [&channel_name](const std::shared_ptr<Stream> &CurrentStream) {
-        return CurrentStream->getChannelInfo().channel_name == channel_name;
-      });
-  if (FoundChannel == StreamPointers.end()) {
+  std::lock_guard<std::mutex> lock(StreamsMutex);
+  auto FoundChannel = StreamsByChannel.find(channel_name);
+  if (FoundChannel == StreamsByChannel.end()) {
     return nullptr;
   }
-  return *FoundChannel;
+  return FoundChannel->second;
 }
 } // namespace Forwarder
@@ -1,19 +1,50 @@
 #pragma once
 
 #include "Stream.h"
+#include <atomic>
+#include <chrono>
 #include <memory>
 #include <mutex>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace Forwarder {
 
 class Stream;
 
+using StreamList = std::vector<std::shared_ptr<Stream>>;
+
 class Streams {
 private:
-  std::vector<std::shared_ptr<Stream>> StreamPointers;
+  /// Dense list of the streams in the order they were added, used for
+  /// scheduling.
+  StreamList StreamPointers;
+  /// The first added stream of each channel, for constant time lookups.
+  std::unordered_map<std::string, std::shared_ptr<Stream>> StreamsByChannel;
   std::mutex StreamsMutex;
+  /// Read-only copy of StreamPointers for the conversion workers.
+  ///
+  /// Republished right away when streams are removed so that they are not kept
+  /// alive, but only on demand after additions as those come in bulk.
+  std::shared_ptr<StreamList const> Snapshot{std::make_shared<StreamList>()};
+  std::atomic<bool> SnapshotStale{false};
+
+  /// Removed streams which may still be in use, see reclaimRetired().
+  struct RetiredStream {
+    std::shared_ptr<Stream> Retired;
+    std::chrono::steady_clock::time_point RetiredAt;
+  };
+  std::mutex RetiredMutex;
+  std::vector<RetiredStream> RetiredStreams;
+
+  /// Stops the streams and puts them on the reclamation list.
+  void retire(StreamList::iterator Begin, StreamList::iterator End);
+
+  /// Replaces the snapshot, must be called with StreamsMutex held.
+  void publishSnapshot();
+  /// Rebuilds StreamsByChannel, must be called with StreamsMutex held.
+  void rebuildIndex();
 
 public:
   /// Gets the number of streams.
@@ -29,6 +60,14 @@ public:
   /// Clear all the streams.
   void clearStreams();
 
+  /// Destroys the removed streams which no conversion worker uses any longer
+  /// and which were stopped at least GracePeriod ago, so that late EPICS
+  /// callbacks do not hit a destroyed client.
+  ///
+  /// \return The number of removed streams which still wait.
+  size_t reclaimRetired(
+      std::chrono::milliseconds GracePeriod = std::chrono::milliseconds(1000));
+
   /// Check the status of the streams and stop any that are in error.
   void checkStreamStatus();
 
@@ -50,5 +89,15 @@ public:
   std::shared_ptr<Stream> back();
   std::shared_ptr<Stream> operator[](size_t s) { return StreamPointers.at(s); };
   const std::vector<std::shared_ptr<Stream>> &getStreams() const;
+
+  /// Get an immutable copy of the current list of streams.
+  ///
+  /// Never waits for the lock: after additions the snapshot is only
+  /// republished if the lock is free, otherwise the previous snapshot is
+  /// returned.  That makes it cheap enough to be called on every conversion
+  /// queue refill, even while a command adds many streams.
+  ///
+  /// \return The current streams in the order in which they were added.
+  std::shared_ptr<StreamList const> getStreamsSnapshot();
 };
 } // namespace Forwarder
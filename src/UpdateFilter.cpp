@@ -0,0 +1,74 @@
+#include "UpdateFilter.h"
+#include "helper.h"
+#include <cmath>
+
+namespace Forwarder {
+
+std::unique_ptr<UpdateFilter>
+UpdateFilter::create(FilterSettings const &Settings) {
+  if (Settings.DeadbandAbsolute <= 0 && Settings.DeadbandRelative <= 0 &&
+      Settings.MinIntervalMS == 0) {
+    return nullptr;
+  }
+  return ::make_unique<DeadbandFilter>(Settings);
+}
+
+DeadbandFilter::DeadbandFilter(FilterSettings const &Settings)
+    : Settings(Settings) {}
+
+/// \return The value field if it is a numeric scalar.
+static epics::pvData::PVScalar const *
+numericValue(FlatBufs::EpicsPVUpdate const &Update) {
+  if (Update.epics_pvstr == nullptr) {
+    return nullptr;
+  }
+  auto Value =
+      Update.epics_pvstr->getSubField<epics::pvData::PVScalar>("value");
+  if (Value == nullptr) {
+    return nullptr;
+  }
+  auto Type = Value->getScalar()->getScalarType();
+  if (!epics::pvData::ScalarTypeFunc::isNumeric(Type)) {
+    return nullptr;
+  }
+  return Value.get();
+}
+
+bool DeadbandFilter::withinDeadband(double Value) const {
+  if (!HaveLastValue) {
+    return false;
+  }
+  auto Change = std::abs(Value - LastValue);
+  if (Settings.DeadbandAbsolute > 0 && Change <= Settings.DeadbandAbsolute) {
+    return true;
+  }
+  return Settings.DeadbandRelative > 0 &&
+         Change <= Settings.DeadbandRelative * std::abs(LastValue);
+}
+
+bool DeadbandFilter::accept(FlatBufs::EpicsPVUpdate const &Update) {
+  if (Settings.MinIntervalMS > 0 && HaveLastTimestamp &&
+      Update.ts_epics_monitor <
+          LastTimestamp + Settings.MinIntervalMS * 1000000) {
+    return false;
+  }
+  bool HaveValue = false;
+  double Value = 0;
+  if (Settings.DeadbandAbsolute > 0 || Settings.DeadbandRelative > 0) {
+    if (auto Scalar = numericValue(Update)) {
+      Value = Scalar->getAs<double>();
+      HaveValue = true;
+      if (withinDeadband(Value)) {
+        return false;
+      }
+    }
+  }
+  if (HaveValue) {
+    HaveLastValue = true;
+    LastValue = Value;
+  }
+  HaveLastTimestamp = true;
+  LastTimestamp = Update.ts_epics_monitor;
+  return true;
+}
+} // namespace Forwarder
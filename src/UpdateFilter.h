@@ -0,0 +1,46 @@
+#pragma once
+
+#include "ConfigParser.h"
+#include "EpicsPVUpdate.h"
+#include <memory>
+
+namespace Forwarder {
+
+/// Decides which PV updates of a Stream are handed to the conversion paths.
+///
+/// A filter is only ever called by one conversion worker at a time and in the
+/// order in which the updates arrived.
+class UpdateFilter {
+public:
+  virtual ~UpdateFilter() = default;
+
+  /// \return True if the update should be converted.
+  virtual bool accept(FlatBufs::EpicsPVUpdate const &Update) = 0;
+
+  /// Creates the filter for the given settings.
+  ///
+  /// \return The filter or nullptr if the settings do not filter anything.
+  static std::unique_ptr<UpdateFilter> create(FilterSettings const &Settings);
+};
+
+/// Drops updates of scalar numeric PVs whose value did not change by more than
+/// the deadband, and updates which follow the last accepted one too closely.
+///
+/// The deadband is compared against the last accepted value.  If both the
+/// absolute and the relative deadband are given, the change has to exceed
+/// both of them.  Non-numeric values are only subject to the minimum interval.
+class DeadbandFilter : public UpdateFilter {
+public:
+  explicit DeadbandFilter(FilterSettings const &Settings);
+  bool accept(FlatBufs::EpicsPVUpdate const &Update) override;
+
+private:
+  bool withinDeadband(double Value) const;
+
+  FilterSettings Settings;
+  bool HaveLastValue = false;
+  double LastValue = 0;
+  bool HaveLastTimestamp = false;
+  uint64_t LastTimestamp = 0;
+};
+} // namespace Forwarder
@@ -0,0 +1,41 @@
+#include "WorkSignal.h"
+
+namespace Forwarder {
+
+/// Number of polls of the epoch before a worker parks.
+static int const SpinIterations = 2000;
+
+uint64_t WorkSignal::prepareWait() const { return Epoch.load(); }
+
+void WorkSignal::notify() {
+  ++Epoch;
+  if (Waiters.load() > 0) {
+    // Taking the mutex orders us after a waiter which has already checked the
+    // epoch but not yet started to wait on the condition variable.
+    std::lock_guard<std::mutex> Lock(Mutex);
+    Condition.notify_one();
+  }
+}
+
+void WorkSignal::notifyAll() {
+  ++Epoch;
+  std::lock_guard<std::mutex> Lock(Mutex);
+  Condition.notify_all();
+}
+
+bool WorkSignal::wait(uint64_t Ticket, std::chrono::milliseconds Timeout) {
+  // Under load the next update is usually only microseconds away, spinning
+  // for a moment is much cheaper than a round trip through the kernel.
+  for (int i = 0; i < SpinIterations; ++i) {
+    if (Epoch.load(std::memory_order_relaxed) != Ticket) {
+      return true;
+    }
+  }
+  std::unique_lock<std::mutex> Lock(Mutex);
+  ++Waiters;
+  bool Notified = Condition.wait_for(
+      Lock, Timeout, [this, Ticket] { return Epoch.load() != Ticket; });
+  --Waiters;
+  return Notified;
+}
+} // namespace Forwarder
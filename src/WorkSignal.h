@@ -0,0 +1,41 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+namespace Forwarder {
+
+/// Lets idle conversion workers park until new PV updates are available.
+///
+/// Producers call notify() after they enqueued an update.  As long as no
+/// worker is parked this is a single atomic increment.  A worker takes a
+/// ticket with prepareWait() *before* it looks for work and passes it to
+/// wait() afterwards, so a notification that arrives in between is not lost.
+class WorkSignal {
+public:
+  /// \return The ticket to pass to wait().
+  uint64_t prepareWait() const;
+
+  /// Wakes up one parked worker, if any.
+  void notify();
+
+  /// Wakes up all parked workers, e.g. on shutdown.
+  void notifyAll();
+
+  /// Spins briefly and then parks until notified or the timeout expires.
+  ///
+  /// \param Ticket The value returned by prepareWait().
+  /// \param Timeout Maximum time to stay parked.
+  /// \return True if woken by a notification, false on timeout.
+  bool wait(uint64_t Ticket, std::chrono::milliseconds Timeout);
+
+private:
+  std::atomic<uint64_t> Epoch{0};
+  std::atomic<uint32_t> Waiters{0};
+  std::mutex Mutex;
+  std::condition_variable Condition;
+};
+} // namespace Forwarder
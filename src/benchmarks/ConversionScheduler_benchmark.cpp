@@ -0,0 +1,69 @@
+#include "../ConversionWorker.h"
+#include "../Stream.h"
+#include "../Streams.h"
+#include "../helper.h"
+#include "../tests/StreamTestUtils.h"
+#include <chrono>
+#include <fmt/format.h>
+
+using namespace Forwarder;
+
+/// Converts a fixed backlog of updates with the given number of conversion
+/// threads.
+///
+/// \return The number of converted updates per second.
+static double measureThroughput(size_t NumThreads, size_t NumStreams,
+                                size_t UpdatesPerStream) {
+  std::atomic<uint64_t> Counter{0};
+  Streams StreamList;
+  ConversionScheduler Scheduler(StreamList);
+  auto Update = std::make_shared<FlatBufs::EpicsPVUpdate>();
+  for (size_t i = 0; i < NumStreams; ++i) {
+    auto Queue = std::make_shared<PVUpdateQueue>(Scheduler.getWorkSignal());
+    ChannelInfo Info{"provider", "channel" + std::to_string(i)};
+    auto NewStream = std::make_shared<Stream>(
+        Info, std::make_shared<FakeEpicsClient>(), Queue);
+    auto Path = ::make_unique<FakeConversionPath>("topic" + std::to_string(i),
+                                                  "f142", &Counter);
+    Path->WorkPerUpdate = 500;
+    NewStream->addConverter(std::move(Path));
+    for (size_t j = 0; j < UpdatesPerStream; ++j) {
+      Queue->enqueue(Update);
+    }
+    StreamList.add(NewStream);
+  }
+  std::vector<std::unique_ptr<ConversionWorker>> Workers;
+  for (size_t i = 0; i < NumThreads; ++i) {
+    Workers.push_back(::make_unique<ConversionWorker>(&Scheduler, 1024));
+  }
+  uint64_t const Total = NumStreams * UpdatesPerStream;
+  auto Start = std::chrono::steady_clock::now();
+  for (auto &Worker : Workers) {
+    Worker->start();
+  }
+  while (Counter.load() < Total) {
+    std::this_thread::sleep_for(std::chrono::microseconds(200));
+  }
+  auto Elapsed = std::chrono::duration_cast<std::chrono::duration<double>>(
+      std::chrono::steady_clock::now() - Start);
+  for (auto &Worker : Workers) {
+    Worker->stop();
+  }
+  return Total / Elapsed.count();
+}
+
+/// Prints the number of updates per second which the conversion workers
+/// take from the streams, for an increasing number of conversion threads.
+int main() {
+  size_t const NumStreams = 256;
+  size_t const UpdatesPerStream = 4000;
+  fmt::print("{} streams with {} queued updates each\n", NumStreams,
+             UpdatesPerStream);
+  for (size_t NumThreads : {1u, 2u, 4u, 8u}) {
+    auto Throughput =
+        measureThroughput(NumThreads, NumStreams, UpdatesPerStream);
+    fmt::print("{} conversion threads: {:.0f} updates/s\n", NumThreads,
+               Throughput);
+  }
+  return 0;
+}
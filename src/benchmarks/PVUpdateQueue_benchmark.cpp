@@ -0,0 +1,60 @@
+#include "../EpicsPVUpdate.h"
+#include "../PVUpdateQueue.h"
+#include <chrono>
+#include <fmt/format.h>
+#include <thread>
+#include <vector>
+
+using namespace Forwarder;
+
+/// Moves the updates from two producer threads through the queue, like the
+/// EPICS monitor and the PV update timer do.
+///
+/// \return The time per update in nanoseconds.
+static double measureEnqueue(bool UseTokens, size_t Count) {
+  PVUpdateQueue Queue;
+  // Created up front so that only the queue is measured
+  std::vector<std::shared_ptr<FlatBufs::EpicsPVUpdate>> Updates;
+  for (size_t i = 0; i < Count; ++i) {
+    Updates.push_back(std::make_shared<FlatBufs::EpicsPVUpdate>());
+  }
+  auto Produce = [&Queue, &Updates, UseTokens]() {
+    auto Token = Queue.createProducerToken();
+    for (auto const &Update : Updates) {
+      if (UseTokens) {
+        Queue.enqueue(Token, Update);
+      } else {
+        Queue.enqueue(Update);
+      }
+    }
+  };
+  auto Start = std::chrono::steady_clock::now();
+  std::thread Monitor(Produce);
+  std::thread Timer(Produce);
+  auto ConsumerToken = Queue.createConsumerToken();
+  std::vector<std::shared_ptr<FlatBufs::EpicsPVUpdate>> Buffer(1024);
+  size_t NumDequeued = 0;
+  while (NumDequeued < 2 * Count) {
+    NumDequeued +=
+        Queue.tryDequeueBulk(ConsumerToken, Buffer.data(), Buffer.size());
+  }
+  Monitor.join();
+  Timer.join();
+  auto Elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now() - Start);
+  return static_cast<double>(Elapsed.count()) / (2 * Count);
+}
+
+/// Prints the cost per update of enqueueing through the implicit producers
+/// of the queue and through explicit producer tokens.
+int main() {
+  size_t const Count = 1000000;
+  fmt::print("2 producers with {} updates each\n", Count);
+  for (int Round = 0; Round < 3; ++Round) {
+    fmt::print("implicit producers: {:.1f} ns/update\n",
+               measureEnqueue(false, Count));
+    fmt::print("producer tokens:    {:.1f} ns/update\n",
+               measureEnqueue(true, Count));
+  }
+  return 0;
+}
@@ -1,10 +1,13 @@
+#include "../../BatchingFlatBufferCreator.h"
 #include "../../EpicsPVUpdate.h"
+#include "../../FlatBufferBuilderPool.h"
 #include "../../RangeSet.h"
 #include "../../SchemaRegistry.h"
 #include "../../helper.h"
 #include "../../logger.h"
 #include "schemas/f142_logdata_generated.h"
 #include <atomic>
+#include <map>
 #include <mutex>
 #include <pv/nt.h>
 #include <pv/ntndarray.h>
@@ -12,6 +15,7 @@
 #include <pv/ntutils.h>
 #include <pv/pvEnumerated.h>
 #include <set>
+#include <unordered_map>
 
 namespace FlatBufs {
 namespace f142 {
@@ -21,9 +25,10 @@ typedef struct {
   flatbuffers::Offset<void> Offset;
 } Value_t;
 
+/// Converters may be used from several threads at once.
 struct Statistics {
-  uint64_t err_timestamp_not_available = 0;
-  uint64_t err_not_implemented_yet = 0;
+  std::atomic<uint64_t> err_timestamp_not_available{0};
+  std::atomic<uint64_t> err_not_implemented_yet{0};
 };
 
 namespace PVStructureToFlatBufferN {
@@ -177,7 +182,8 @@ public:
                          bool UseMemCpy) {
     auto ValueField =
         static_cast<epics::pvData::PVValueArray<T0> *>(ValueSubField);
-    ValueField->setImmutable();
+    // No setImmutable() here, the structure may be a monitor element which
+    // pvAccess reuses after we are done with it.
     auto Value = ValueField->view();
     auto ValueSize = Value.size();
 
@@ -204,8 +210,7 @@ public:
   static Value_t convert(flatbuffers::FlatBufferBuilder *Builder,
                          epics::pvData::PVScalar *PVScalarValue) {
     auto PVScalarString =
-        dynamic_cast<epics::pvData::PVScalarValue<std::string> *>(
-            PVScalarValue);
+        static_cast<epics::pvData::PVScalarValue<std::string> *>(PVScalarValue);
     std::string Value = PVScalarString->get();
     auto FlatbufferedValueString =
         Builder->CreateString(Value.data(), Value.size());
@@ -218,135 +223,359 @@ public:
 
 } // end namespace PVStructureToFlatBufferN
 
-Value_t makeValueScalar(flatbuffers::FlatBufferBuilder &builder,
-                        epics::pvData::PVScalar *field, Statistics &Stats) {
+/// Encodes the value field of a PV update, specialized for one field type and
+/// selected once per structure.
+struct ValueEncoder {
+  /// Adds the value to the builder.
+  Value_t (*Convert)(flatbuffers::FlatBufferBuilder &Builder,
+                     epics::pvData::PVField *ValueField, bool UseMemCpy);
+  /// \return Upper bound of the bytes which Convert adds to the builder.
+  size_t (*EncodedSize)(epics::pvData::PVField *ValueField);
+};
+
+/// Vtable, offset and alignment of the value table in the union.
+static size_t const ValueTableOverhead = 32;
+
+template <typename T0>
+Value_t convertScalar(flatbuffers::FlatBufferBuilder &Builder,
+                      epics::pvData::PVField *ValueField, bool) {
+  return PVStructureToFlatBufferN::Make_Scalar<T0>::convert(
+      &Builder, static_cast<epics::pvData::PVScalar *>(ValueField));
+}
+
+template <typename T0> size_t encodedSizeScalar(epics::pvData::PVField *) {
+  return ValueTableOverhead + sizeof(T0);
+}
+
+Value_t convertScalarString(flatbuffers::FlatBufferBuilder &Builder,
+                            epics::pvData::PVField *ValueField, bool) {
+  return PVStructureToFlatBufferN::MakeScalarString::convert(
+      &Builder, static_cast<epics::pvData::PVScalar *>(ValueField));
+}
+
+size_t encodedSizeScalarString(epics::pvData::PVField *ValueField) {
+  // Length prefix and terminating zero of the string
+  return ValueTableOverhead + 8 +
+         static_cast<epics::pvData::PVScalarValue<std::string> *>(ValueField)
+             ->get()
+             .size();
+}
+
+template <typename T0>
+Value_t convertScalarArray(flatbuffers::FlatBufferBuilder &Builder,
+                           epics::pvData::PVField *ValueField,
+                           bool UseMemCpy) {
+  return PVStructureToFlatBufferN::Make_ScalarArray<T0>::convert(
+      &Builder, static_cast<epics::pvData::PVScalarArray *>(ValueField),
+      UseMemCpy);
+}
+
+template <typename T0>
+size_t encodedSizeScalarArray(epics::pvData::PVField *ValueField) {
+  // Length prefix and alignment of the vector
+  return ValueTableOverhead + 16 +
+         sizeof(T0) *
+             static_cast<epics::pvData::PVScalarArray *>(ValueField)
+                 ->getLength();
+}
+
+template <typename T0> ValueEncoder const *scalarEncoder() {
+  static ValueEncoder const Encoder{convertScalar<T0>, encodedSizeScalar<T0>};
+  return &Encoder;
+}
+
+ValueEncoder const *scalarStringEncoder() {
+  static ValueEncoder const Encoder{convertScalarString,
+                                    encodedSizeScalarString};
+  return &Encoder;
+}
+
+template <typename T0> ValueEncoder const *scalarArrayEncoder() {
+  static ValueEncoder const Encoder{convertScalarArray<T0>,
+                                    encodedSizeScalarArray<T0>};
+  return &Encoder;
+}
+
+#if HAVE_F142_ARRAY_STRING
+Value_t convertScalarStringArray(flatbuffers::FlatBufferBuilder &Builder,
+                                 epics::pvData::PVField *ValueField, bool) {
+  auto Strings =
+      static_cast<epics::pvData::PVStringArray *>(ValueField)->view();
+  // Same as CreateVectorOfStrings() but without copying the strings into a
+  // std::vector first
+  std::vector<flatbuffers::Offset<flatbuffers::String>> Offsets;
+  Offsets.reserve(Strings.size());
+  for (auto const &String : Strings) {
+    Offsets.push_back(Builder.CreateString(String));
+  }
+  auto VectorValue = Builder.CreateVector(Offsets);
+  ArrayStringBuilder ValueBuilder(Builder);
+  ValueBuilder.add_value(VectorValue);
+  return {Value::ArrayString, ValueBuilder.Finish().Union()};
+}
+
+size_t encodedSizeScalarStringArray(epics::pvData::PVField *ValueField) {
+  auto Strings =
+      static_cast<epics::pvData::PVStringArray *>(ValueField)->view();
+  // Offset in the vector, length prefix, terminating zero and padding of
+  // every string
+  size_t Size = ValueTableOverhead + 16 + 12 * Strings.size();
+  for (auto const &String : Strings) {
+    Size += String.size();
+  }
+  return Size;
+}
+
+ValueEncoder const *scalarStringArrayEncoder() {
+  static ValueEncoder const Encoder{convertScalarStringArray,
+                                    encodedSizeScalarStringArray};
+  return &Encoder;
+}
+#endif
+
+ValueEncoder const *selectScalarEncoder(epics::pvData::ScalarType Type) {
   using S = epics::pvData::ScalarType;
-  using namespace epics::pvData;
-  using namespace PVStructureToFlatBufferN;
-  switch (field->getScalar()->getScalarType()) {
+  switch (Type) {
   case S::pvBoolean:
-    return Make_Scalar<epics::pvData::boolean>::convert(&builder, field);
+    return scalarEncoder<epics::pvData::boolean>();
   case S::pvByte:
-    return Make_Scalar<int8_t>::convert(&builder, field);
+    return scalarEncoder<int8_t>();
   case S::pvShort:
-    return Make_Scalar<int16_t>::convert(&builder, field);
+    return scalarEncoder<int16_t>();
   case S::pvInt:
-    return Make_Scalar<int32_t>::convert(&builder, field);
+    return scalarEncoder<int32_t>();
   case S::pvLong:
-    return Make_Scalar<int64_t>::convert(&builder, field);
+    return scalarEncoder<int64_t>();
   case S::pvUByte:
-    return Make_Scalar<uint8_t>::convert(&builder, field);
+    return scalarEncoder<uint8_t>();
   case S::pvUShort:
-    return Make_Scalar<uint16_t>::convert(&builder, field);
+    return scalarEncoder<uint16_t>();
   case S::pvUInt:
-    return Make_Scalar<uint32_t>::convert(&builder, field);
+    return scalarEncoder<uint32_t>();
   case S::pvULong:
-    return Make_Scalar<uint64_t>::convert(&builder, field);
+    return scalarEncoder<uint64_t>();
   case S::pvFloat:
-    return Make_Scalar<float>::convert(&builder, field);
+    return scalarEncoder<float>();
   case S::pvDouble:
-    return Make_Scalar<double>::convert(&builder, field);
+    return scalarEncoder<double>();
   case S::pvString:
-    return MakeScalarString::convert(&builder, field);
-  default:
-    ++Stats.err_not_implemented_yet;
-    break;
+    return scalarStringEncoder();
   }
-  return {Value::NONE, 0};
+  return nullptr;
 }
 
-Value_t makeValueArray(flatbuffers::FlatBufferBuilder &Builder,
-                       epics::pvData::PVScalarArray *ScalarArrayField,
-                       bool opts, Statistics &Stats) {
+ValueEncoder const *selectScalarArrayEncoder(epics::pvData::ScalarType Type) {
   using S = epics::pvData::ScalarType;
-  using namespace epics::pvData;
-  using namespace PVStructureToFlatBufferN;
-  switch (ScalarArrayField->getScalarArray()->getElementType()) {
+  switch (Type) {
   case S::pvBoolean:
-    return Make_ScalarArray<epics::pvData::boolean>::convert(
-        &Builder, ScalarArrayField, opts);
+    return scalarArrayEncoder<epics::pvData::boolean>();
   case S::pvByte:
-    return Make_ScalarArray<int8_t>::convert(&Builder, ScalarArrayField, opts);
+    return scalarArrayEncoder<int8_t>();
   case S::pvShort:
-    return Make_ScalarArray<int16_t>::convert(&Builder, ScalarArrayField, opts);
+    return scalarArrayEncoder<int16_t>();
   case S::pvInt:
-    return Make_ScalarArray<int32_t>::convert(&Builder, ScalarArrayField, opts);
+    return scalarArrayEncoder<int32_t>();
   case S::pvLong:
-    return Make_ScalarArray<int64_t>::convert(&Builder, ScalarArrayField, opts);
+    return scalarArrayEncoder<int64_t>();
   case S::pvUByte:
-    return Make_ScalarArray<uint8_t>::convert(&Builder, ScalarArrayField, opts);
+    return scalarArrayEncoder<uint8_t>();
   case S::pvUShort:
-    return Make_ScalarArray<uint16_t>::convert(&Builder, ScalarArrayField,
-                                               opts);
+    return scalarArrayEncoder<uint16_t>();
   case S::pvUInt:
-    return Make_ScalarArray<uint32_t>::convert(&Builder, ScalarArrayField,
-                                               opts);
+    return scalarArrayEncoder<uint32_t>();
   case S::pvULong:
-    return Make_ScalarArray<uint64_t>::convert(&Builder, ScalarArrayField,
-                                               opts);
+    return scalarArrayEncoder<uint64_t>();
   case S::pvFloat:
-    return Make_ScalarArray<float>::convert(&Builder, ScalarArrayField, opts);
+    return scalarArrayEncoder<float>();
   case S::pvDouble:
-    return Make_ScalarArray<double>::convert(&Builder, ScalarArrayField, opts);
+    return scalarArrayEncoder<double>();
   case S::pvString:
-    ++Stats.err_not_implemented_yet;
+#if HAVE_F142_ARRAY_STRING
+    return scalarStringArrayEncoder();
+#else
     break;
+#endif
   }
-  return {Value::NONE, 0};
+  return nullptr;
 }
 
-Value_t makeValue(flatbuffers::FlatBufferBuilder &Builder,
-                  epics::pvData::PVStructurePtr const &PVStructureField,
-                  bool opts, Statistics &Stats) {
-  if (!PVStructureField) {
-    return {Value::NONE, 0};
-  }
-  auto ValueField = PVStructureField->getSubField("value");
-  if (!ValueField) {
-    return {Value::NONE, 0};
+/// \return The encoder for the type of a field which is not part of a
+/// structure layout, nullptr if the type is not supported.
+ValueEncoder const *selectFieldEncoder(epics::pvData::PVField *Field) {
+  if (Field == nullptr) {
+    return nullptr;
   }
-  // Check the type of 'value'
-  // Optionally, compare with name of the PV?
-  // Create appropriate fb union
-  // CreateVector using the correct types.
-  auto ValueType = ValueField->getField()->getType();
   using PVType = epics::pvData::Type;
-  switch (ValueType) {
+  switch (Field->getField()->getType()) {
   case PVType::scalar:
-    return makeValueScalar(
-        Builder, dynamic_cast<epics::pvData::PVScalar *>(ValueField.get()),
-        Stats);
+    return selectScalarEncoder(static_cast<epics::pvData::PVScalar *>(Field)
+                                   ->getScalar()
+                                   ->getScalarType());
   case PVType::scalarArray:
-    return makeValueArray(
-        Builder, dynamic_cast<epics::pvData::PVScalarArray *>(ValueField.get()),
-        opts, Stats);
-  case PVType::structure: {
-    // supported so far:
-    // NTEnum:  we currently send the index value.  full enum identifier is
-    // coming when it
-    // is decided how we store on nexus side.
-    epics::pvData::PVStructurePtr ComparisonPtr(
-        PVStructureField.get(),
-        [](epics::pvData::PVStructure *) { /* Do nothing. */ });
-    if (epics::nt::NTEnum::isCompatible(ComparisonPtr)) {
-      auto IndexField = ((epics::pvData::PVStructure *)(ValueField.get()))
-                            ->getSubField("index");
-      return makeValueScalar(
-          Builder, dynamic_cast<epics::pvData::PVScalar *>(IndexField.get()),
-          Stats);
-    }
+    return selectScalarArrayEncoder(
+        static_cast<epics::pvData::PVScalarArray *>(Field)
+            ->getScalarArray()
+            ->getElementType());
+  default:
     break;
   }
-  case PVType::structureArray:
-    break;
-  case PVType::union_:
-    break;
-  case PVType::unionArray:
-    break;
+  return nullptr;
+}
+
+/// The type of a union can change with every update, so the encoder of the
+/// selected member is looked up each time.
+Value_t convertUnion(flatbuffers::FlatBufferBuilder &Builder,
+                     epics::pvData::PVField *ValueField, bool UseMemCpy) {
+  auto Selected = static_cast<epics::pvData::PVUnion *>(ValueField)->get();
+  if (auto Encoder = selectFieldEncoder(Selected.get())) {
+    return Encoder->Convert(Builder, Selected.get(), UseMemCpy);
   }
   return {Value::NONE, 0};
 }
 
+size_t encodedSizeUnion(epics::pvData::PVField *ValueField) {
+  auto Selected = static_cast<epics::pvData::PVUnion *>(ValueField)->get();
+  if (auto Encoder = selectFieldEncoder(Selected.get())) {
+    return Encoder->EncodedSize(Selected.get());
+  }
+  return 0;
+}
+
+ValueEncoder const *unionEncoder() {
+  static ValueEncoder const Encoder{convertUnion, encodedSizeUnion};
+  return &Encoder;
+}
+
+/// Where to find the fields of a PV structure and how to convert its value.
+///
+/// Resolved once per introspection structure, updates of a channel usually
+/// all share the same one.  Offsets are relative to the top level structure,
+/// 0 means that the field does not exist.
+struct FieldLayout {
+  epics::pvData::StructureConstPtr Structure;
+  size_t ValueOffset = 0;
+  ValueEncoder const *Encoder = nullptr;
+  size_t SecondsOffset = 0;
+  size_t NanosecondsOffset = 0;
+  size_t AlarmSeverityOffset = 0;
+  size_t AlarmMessageOffset = 0;
+};
+
+std::shared_ptr<FieldLayout const>
+resolveLayout(epics::pvData::PVStructure const &PVStructure) {
+  auto Layout = std::make_shared<FieldLayout>();
+  Layout->Structure = PVStructure.getStructure();
+  if (auto ValueField = PVStructure.getSubField("value")) {
+    // Check the type of 'value'
+    // Optionally, compare with name of the PV?
+    // Create appropriate fb union
+    // CreateVector using the correct types.
+    using PVType = epics::pvData::Type;
+    switch (ValueField->getField()->getType()) {
+    case PVType::scalar:
+      Layout->ValueOffset = ValueField->getFieldOffset();
+      Layout->Encoder = selectScalarEncoder(
+          static_cast<epics::pvData::PVScalar *>(ValueField.get())
+              ->getScalar()
+              ->getScalarType());
+      break;
+    case PVType::scalarArray:
+      Layout->ValueOffset = ValueField->getFieldOffset();
+      Layout->Encoder = selectScalarArrayEncoder(
+          static_cast<epics::pvData::PVScalarArray *>(ValueField.get())
+              ->getScalarArray()
+              ->getElementType());
+      break;
+    case PVType::structure: {
+      // supported so far:
+      // NTEnum:  we currently send the index value.  full enum identifier is
+      // coming when it
+      // is decided how we store on nexus side.
+      if (epics::nt::NTEnum::isCompatible(Layout->Structure)) {
+        auto IndexField =
+            static_cast<epics::pvData::PVStructure *>(ValueField.get())
+                ->getSubField<epics::pvData::PVScalar>("index");
+        if (IndexField) {
+          Layout->ValueOffset = IndexField->getFieldOffset();
+          Layout->Encoder =
+              selectScalarEncoder(IndexField->getScalar()->getScalarType());
+        }
+      }
+      break;
+    }
+    case PVType::union_:
+      // Scalars and scalar arrays selected in the union are forwarded
+      Layout->ValueOffset = ValueField->getFieldOffset();
+      Layout->Encoder = unionEncoder();
+      break;
+    case PVType::structureArray:
+    case PVType::unionArray:
+      // No representation in f142, counted as not implemented
+      Layout->ValueOffset = ValueField->getFieldOffset();
+      break;
+    }
+  }
+  if (auto PVTimeStamp =
+          PVStructure.getSubField<epics::pvData::PVStructure>("timeStamp")) {
+    auto Seconds =
+        PVTimeStamp->getSubField<epics::pvData::PVScalarValue<int64_t>>(
+            "secondsPastEpoch");
+    auto Nanoseconds =
+        PVTimeStamp->getSubField<epics::pvData::PVScalarValue<int32_t>>(
+            "nanoseconds");
+    if (Seconds && Nanoseconds) {
+      Layout->SecondsOffset = Seconds->getFieldOffset();
+      Layout->NanosecondsOffset = Nanoseconds->getFieldOffset();
+    }
+  }
+  if (auto PVAlarm =
+          PVStructure.getSubField<epics::pvData::PVStructure>("alarm")) {
+    auto Severity =
+        PVAlarm->getSubField<epics::pvData::PVScalarValue<int32_t>>(
+            "severity");
+    auto Message = PVAlarm->getSubField<epics::pvData::PVString>("message");
+    if (Severity && Message) {
+      Layout->AlarmSeverityOffset = Severity->getFieldOffset();
+      Layout->AlarmMessageOffset = Message->getFieldOffset();
+    }
+  }
+  return Layout;
+}
+
+#if HAVE_F142_ALARM
+AlarmSeverity toAlarmSeverity(int32_t Severity) {
+  switch (Severity) {
+  case 0:
+    return AlarmSeverity::NO_ALARM;
+  case 1:
+    return AlarmSeverity::MINOR;
+  case 2:
+    return AlarmSeverity::MAJOR;
+  default:
+    return AlarmSeverity::INVALID;
+  }
+}
+
+/// The EPICS alarm condition is only available as the alarm message, which
+/// uses the same names as the f142 AlarmStatus.
+///
+/// \return False if the message is not a known alarm condition.
+bool toAlarmStatus(std::string const &Message, AlarmStatus &Status) {
+  if (Message.empty()) {
+    Status = AlarmStatus::NO_ALARM;
+    return true;
+  }
+  auto Names = EnumNamesAlarmStatus();
+  for (size_t i = 0; Names[i] != nullptr; ++i) {
+    if (Message == Names[i]) {
+      Status = static_cast<AlarmStatus>(i);
+      return true;
+    }
+  }
+  return false;
+}
+#endif
+
 class Converter : public FlatBufferCreator {
 public:
   Converter() = default;
@@ -355,46 +584,264 @@ public:
 
   std::unique_ptr<FlatBufs::FlatbufferMessage>
   create(EpicsPVUpdate const &PVUpdate) override {
+    if (Alarms.load() == AlarmMode::Only) {
+      return createAlarmOnly(PVUpdate);
+    }
     auto &PVStructure = PVUpdate.epics_pvstr;
-    auto FlatbufferMessage = make_unique<FlatBufs::FlatbufferMessage>();
+    std::shared_ptr<FieldLayout const> Layout;
+    epics::pvData::PVField *ValueField = nullptr;
+    // LogData table, source name and timestamp
+    size_t MessageSize = LogDataOverhead + PVUpdate.channel.size();
+    if (PVStructure) {
+      Layout = getLayout(*PVStructure);
+      if (Layout->Encoder != nullptr) {
+        ValueField = PVStructure->getSubFieldImpl(Layout->ValueOffset, false);
+        MessageSize += Layout->Encoder->EncodedSize(ValueField);
+      } else if (Layout->ValueOffset != 0) {
+        ++Stats.err_not_implemented_yet;
+      }
+    }
+    auto FlatbufferMessage =
+        BuilderPool->acquire(static_cast<uint32_t>(MessageSize));
 
     auto Builder = FlatbufferMessage->builder.get();
     // this is the field type ID string: up.pvstr->getStructure()->getID()
     auto PVName = Builder->CreateString(PVUpdate.channel);
-    auto Value = makeValue(*Builder, PVStructure, true, Stats);
+    Value_t Converted{Value::NONE, 0};
+    if (ValueField != nullptr) {
+      Converted = Layout->Encoder->Convert(*Builder, ValueField, true);
+      if (Converted.Type == Value::NONE) {
+        // A union member of a type which f142 can not represent
+        ++Stats.err_not_implemented_yet;
+      }
+    }
 
     LogDataBuilder LogDataBuilder(*Builder);
     LogDataBuilder.add_source_name(PVName);
-    LogDataBuilder.add_value_type(Value.Type);
-    LogDataBuilder.add_value(Value.Offset);
-
-    if (auto PVTimeStamp =
-            PVStructure->getSubField<epics::pvData::PVStructure>("timeStamp")) {
-      uint64_t TimeStamp = static_cast<uint64_t>(
-          PVTimeStamp
-              ->getSubField<epics::pvData::PVScalarValue<int64_t>>(
-                  "secondsPastEpoch")
-              ->get());
-      TimeStamp *= 1000000000;
-      TimeStamp += PVTimeStamp
-                       ->getSubField<epics::pvData::PVScalarValue<int32_t>>(
-                           "nanoseconds")
-                       ->get();
-      LogDataBuilder.add_timestamp(TimeStamp);
+    LogDataBuilder.add_value_type(Converted.Type);
+    LogDataBuilder.add_value(Converted.Offset);
+
+    if (Layout) {
+      addTimestamp(LogDataBuilder, *PVStructure, *Layout);
     } else {
       ++Stats.err_timestamp_not_available;
     }
 
+#if HAVE_F142_ALARM
+    if (Layout && Layout->AlarmSeverityOffset != 0) {
+      addAlarm(LogDataBuilder, PVUpdate.channel, *PVStructure, *Layout);
+    }
+#endif
+
     FinishLogDataBuffer(*Builder, LogDataBuilder.Finish());
     return FlatbufferMessage;
   }
 
+  /// \return A message with the alarm and without a value if the alarm
+  /// severity of the channel changed, nullptr otherwise.
+  std::unique_ptr<FlatBufs::FlatbufferMessage>
+  createAlarmOnly(EpicsPVUpdate const &PVUpdate) {
+#if HAVE_F142_ALARM
+    auto &PVStructure = PVUpdate.epics_pvstr;
+    if (!PVStructure) {
+      return nullptr;
+    }
+    auto Layout = getLayout(*PVStructure);
+    if (Layout->AlarmSeverityOffset == 0) {
+      return nullptr;
+    }
+    auto NewAlarm = readAlarm(*PVStructure, *Layout);
+    if (!alarmChanged(PVUpdate.channel, NewAlarm, true)) {
+      return nullptr;
+    }
+    auto FlatbufferMessage = BuilderPool->acquire(
+        static_cast<uint32_t>(LogDataOverhead + PVUpdate.channel.size()));
+    auto Builder = FlatbufferMessage->builder.get();
+    auto PVName = Builder->CreateString(PVUpdate.channel);
+    LogDataBuilder LogDataBuilder(*Builder);
+    LogDataBuilder.add_source_name(PVName);
+    addTimestamp(LogDataBuilder, *PVStructure, *Layout);
+    if (NewAlarm.KnownStatus) {
+      LogDataBuilder.add_status(NewAlarm.Status);
+    }
+    LogDataBuilder.add_severity(toAlarmSeverity(NewAlarm.Severity));
+    FinishLogDataBuffer(*Builder, LogDataBuilder.Finish());
+    return FlatbufferMessage;
+#else
+    (void)PVUpdate;
+    return nullptr;
+#endif
+  }
+
+  void addTimestamp(LogDataBuilder &DataBuilder,
+                    epics::pvData::PVStructure const &PVStructure,
+                    FieldLayout const &Layout) {
+    if (Layout.SecondsOffset == 0) {
+      ++Stats.err_timestamp_not_available;
+      return;
+    }
+    uint64_t TimeStamp = static_cast<uint64_t>(
+        static_cast<epics::pvData::PVScalarValue<int64_t> *>(
+            PVStructure.getSubFieldImpl(Layout.SecondsOffset, false))
+            ->get());
+    TimeStamp *= 1000000000;
+    TimeStamp += static_cast<epics::pvData::PVScalarValue<int32_t> *>(
+                     PVStructure.getSubFieldImpl(Layout.NanosecondsOffset,
+                                                 false))
+                     ->get();
+    DataBuilder.add_timestamp(TimeStamp);
+  }
+
+  void config(std::map<std::string, std::string> const &Config) override {
+    auto It = Config.find("alarm");
+    if (It != Config.end()) {
+      if (It->second == "always") {
+        Alarms = AlarmMode::Always;
+      } else if (It->second == "on_change") {
+        Alarms = AlarmMode::OnChange;
+      } else if (It->second == "only") {
+        Alarms = AlarmMode::Only;
+#if !HAVE_F142_ALARM
+        LOG(Sev::Warning, "The f142 schema has no alarm fields, nothing will "
+                          "be sent with alarm setting \"only\"");
+#endif
+      } else {
+        LOG(Sev::Warning, "Unknown f142 alarm setting: {}", It->second);
+      }
+    }
+  }
+
+#if HAVE_F142_ALARM
+  struct AlarmState {
+    int32_t Severity;
+    AlarmStatus Status;
+    bool KnownStatus;
+  };
+
+  AlarmState readAlarm(epics::pvData::PVStructure const &PVStructure,
+                  FieldLayout const &Layout) {
+    AlarmState Result{0, AlarmStatus::NO_ALARM, false};
+    Result.Severity = static_cast<epics::pvData::PVScalarValue<int32_t> *>(
+                          PVStructure.getSubFieldImpl(
+                              Layout.AlarmSeverityOffset, false))
+                          ->get();
+    auto Message = static_cast<epics::pvData::PVString *>(
+                       PVStructure.getSubFieldImpl(Layout.AlarmMessageOffset,
+                                                   false))
+                       ->get();
+    Result.KnownStatus = toAlarmStatus(Message, Result.Status);
+    return Result;
+  }
+
+  /// Remembers the alarm as the last one of the channel.
+  ///
+  /// \param SeverityOnly Ignore changes of the status.
+  /// \return True if the alarm differs from the last one of the channel.
+  bool alarmChanged(std::string const &Channel, AlarmState const &NewAlarm,
+                    bool SeverityOnly) {
+    int64_t Key = static_cast<int64_t>(NewAlarm.Severity) << 32;
+    if (!SeverityOnly) {
+      Key |= static_cast<uint16_t>(NewAlarm.Status);
+    }
+    std::lock_guard<std::mutex> Lock(LastAlarmsMutex);
+    auto Found = LastAlarms.find(Channel);
+    if (Found != LastAlarms.end()) {
+      bool Changed = Found->second != Key;
+      Found->second = Key;
+      return Changed;
+    }
+    if (LastAlarms.size() >= MaxLastAlarms) {
+      // The channels which are gone are not known here, start over
+      LastAlarms.clear();
+    }
+    LastAlarms.emplace(Channel, Key);
+    return true;
+  }
+
+  void addAlarm(LogDataBuilder &DataBuilder, std::string const &Channel,
+                epics::pvData::PVStructure const &PVStructure,
+                FieldLayout const &Layout) {
+    auto NewAlarm = readAlarm(PVStructure, Layout);
+    if (Alarms.load() == AlarmMode::OnChange &&
+        !alarmChanged(Channel, NewAlarm, false)) {
+      DataBuilder.add_status(AlarmStatus::NO_CHANGE);
+      DataBuilder.add_severity(AlarmSeverity::NO_CHANGE);
+      return;
+    }
+    if (NewAlarm.KnownStatus) {
+      DataBuilder.add_status(NewAlarm.Status);
+    }
+    DataBuilder.add_severity(toAlarmSeverity(NewAlarm.Severity));
+  }
+#endif
+
   std::map<std::string, double> getStats() override {
-    return {{"ranges_n", seqs.size()}};
+    return {{"ranges_n", seqs.size()},
+            {"err_timestamp_not_available",
+             Stats.err_timestamp_not_available.load()},
+            {"err_not_implemented_yet", Stats.err_not_implemented_yet.load()},
+            {"builder_allocations", BuilderPool->getNumAllocations()},
+            {"builder_initial_size", BuilderPool->getInitialSize()}};
+  }
+
+  /// \return The layout of the structure, resolved on first use.
+  std::shared_ptr<FieldLayout const>
+  getLayout(epics::pvData::PVStructure const &PVStructure) {
+    auto Structure = PVStructure.getStructure().get();
+    auto Layouts = std::atomic_load(&CachedLayouts);
+    auto It = Layouts->find(Structure);
+    if (It != Layouts->end()) {
+      return It->second;
+    }
+    auto Layout = resolveLayout(PVStructure);
+    std::lock_guard<std::mutex> Lock(CachedLayoutsMutex);
+    auto Updated =
+        std::make_shared<LayoutMap>(*std::atomic_load(&CachedLayouts));
+    if (Updated->size() >= MaxCachedLayouts) {
+      Updated->clear();
+    }
+    (*Updated)[Structure] = Layout;
+    std::atomic_store(&CachedLayouts,
+                      std::shared_ptr<LayoutMap const>(std::move(Updated)));
+    return Layout;
   }
 
+  static size_t const LogDataOverhead = 96;
+
   RangeSet<uint64_t> seqs;
   Statistics Stats;
+  /// The layouts hold on to their structure, so its address is not reused
+  /// while it is a key.
+  using LayoutMap = std::map<epics::pvData::Structure const *,
+                             std::shared_ptr<FieldLayout const>>;
+  /// Layouts of the structures converted so far.  A converter may be shared
+  /// by many channels and used from several threads at once, so the map is
+  /// replaced as a whole and only the writers lock.
+  std::shared_ptr<LayoutMap const> CachedLayouts =
+      std::make_shared<LayoutMap const>();
+  std::mutex CachedLayoutsMutex;
+  /// Bounds the cache for channels which change their structure over and
+  /// over again.
+  static size_t const MaxCachedLayouts = 64;
+  enum class AlarmMode {
+    /// Send the alarm with every value.
+    Always,
+    /// Send the alarm when it changed, NO_CHANGE otherwise.
+    OnChange,
+    /// Send only the alarm without the value, when its severity changed.
+    Only,
+  };
+  std::atomic<AlarmMode> Alarms{AlarmMode::Always};
+  /// Last alarm of each channel for the modes which send changes.
+  /// Converters may be shared by several channels.
+  std::mutex LastAlarmsMutex;
+  std::unordered_map<std::string, int64_t> LastAlarms;
+  /// Bounds the memory of converters whose channels come and go.
+  static size_t const MaxLastAlarms = 16384;
+  /// The converter usually serves a single channel, so the pool adapts to the
+  /// message size of that channel.
+  std::shared_ptr<FlatBufferBuilderPool> BuilderPool =
+      std::make_shared<FlatBufferBuilderPool>();
 };
 
 class Info : public SchemaInfo {
@@ -408,5 +855,18 @@ std::unique_ptr<FlatBufferCreator> Info::createConverter() {
 
 FlatBufs::SchemaRegistry::Registrar<Info> g_registrar_info("f142",
                                                            Info::ptr(new Info));
+
+/// f142 messages packed into batches, see BatchingFlatBufferCreator.
+class BatchInfo : public SchemaInfo {
+public:
+  std::unique_ptr<FlatBufferCreator> createConverter() override;
+};
+
+std::unique_ptr<FlatBufferCreator> BatchInfo::createConverter() {
+  return make_unique<BatchingFlatBufferCreator>(make_unique<Converter>());
+}
+
+FlatBufs::SchemaRegistry::Registrar<BatchInfo>
+    g_registrar_batch_info("f142b", BatchInfo::ptr(new BatchInfo));
 } // namespace f142
 } // namespace FlatBufs
@@ -0,0 +1,114 @@
+#include "../BatchingFlatBufferCreator.h"
+#include "../EpicsPVUpdate.h"
+#include "../helper.h"
+#include <cstring>
+#include <gtest/gtest.h>
+#include <thread>
+
+using namespace FlatBufs;
+
+/// Creates a flatbuffer holding the channel name of the update.
+class StringCreator : public FlatBufferCreator {
+public:
+  std::unique_ptr<FlatbufferMessage> create(EpicsPVUpdate const &up) override {
+    auto Message = ::make_unique<FlatbufferMessage>();
+    Message->builder->Finish(Message->builder->CreateString(up.channel));
+    return Message;
+  }
+};
+
+static std::unique_ptr<BatchingFlatBufferCreator>
+createBatching(std::string const &Bytes, std::string const &MS) {
+  auto Creator =
+      ::make_unique<BatchingFlatBufferCreator>(::make_unique<StringCreator>());
+  Creator->config({{"batch_bytes", Bytes}, {"batch_ms", MS}});
+  return Creator;
+}
+
+TEST(BatchingFlatBufferCreatorTest, messages_are_passed_through) {
+  auto Creator = createBatching("100", "100000");
+  EpicsPVUpdate Update;
+  Update.channel = "channel";
+  auto Message = Creator->create(Update);
+  ASSERT_NE(Message, nullptr);
+  auto String =
+      flatbuffers::GetRoot<flatbuffers::String>(Message->message().data);
+  ASSERT_EQ(String->str(), "channel");
+}
+
+TEST(BatchingFlatBufferCreatorTest, batch_is_sent_when_full) {
+  auto Creator = createBatching("100", "100000");
+  auto Batch = Creator->createBatch();
+  ASSERT_NE(Batch, nullptr);
+  EpicsPVUpdate Update;
+  Update.channel = "channel";
+  std::unique_ptr<FlatbufferMessage> Full;
+  size_t NumCreated = 0;
+  while (!Full) {
+    Full = Batch->add(Creator->create(Update));
+    ++NumCreated;
+  }
+  ASSERT_GT(NumCreated, 1u);
+  auto Slice = Full->message();
+  ASSERT_GE(Slice.size, 100u);
+
+  uint32_t NumInHeader = 0;
+  std::memcpy(&NumInHeader, Slice.data, sizeof(NumInHeader));
+  ASSERT_EQ(NumInHeader, NumCreated);
+  ASSERT_EQ(std::string(reinterpret_cast<char const *>(Slice.data) + 4, 4),
+            BatchIdentifier);
+
+  // Walk the entries
+  size_t Offset = 8;
+  size_t NumEntries = 0;
+  while (Offset < Slice.size) {
+    uint32_t Size = 0;
+    uint32_t Reserved = 1;
+    std::memcpy(&Size, Slice.data + Offset, sizeof(Size));
+    std::memcpy(&Reserved, Slice.data + Offset + 4, sizeof(Reserved));
+    ASSERT_EQ(Reserved, 0u);
+    auto String = flatbuffers::GetRoot<flatbuffers::String>(Slice.data +
+                                                            Offset + 8);
+    ASSERT_EQ(String->str(), "channel");
+    Offset += 8 + Size + (8 - Size % 8) % 8;
+    ++NumEntries;
+  }
+  ASSERT_EQ(Offset, Slice.size);
+  ASSERT_EQ(NumEntries, NumCreated);
+  ASSERT_EQ(Creator->getStats()["batches"], 1);
+  ASSERT_EQ(Creator->getStats()["batch_entries"], NumCreated);
+}
+
+TEST(BatchingFlatBufferCreatorTest, batch_is_due_after_deadline) {
+  auto Creator = createBatching("100000", "10");
+  auto Batch = Creator->createBatch();
+  EpicsPVUpdate Update;
+  Update.channel = "channel";
+  ASSERT_EQ(Batch->add(Creator->create(Update)), nullptr);
+  ASSERT_EQ(Batch->takeIfDue(), nullptr);
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  ASSERT_NE(Batch->takeIfDue(), nullptr);
+  ASSERT_EQ(Batch->takeIfDue(), nullptr);
+}
+
+TEST(BatchingFlatBufferCreatorTest, take_hands_out_batch_before_deadline) {
+  auto Creator = createBatching("100000", "100000");
+  auto Batch = Creator->createBatch();
+  ASSERT_EQ(Batch->take(), nullptr);
+  EpicsPVUpdate Update;
+  Update.channel = "channel";
+  ASSERT_EQ(Batch->add(Creator->create(Update)), nullptr);
+  ASSERT_NE(Batch->take(), nullptr);
+  ASSERT_EQ(Batch->take(), nullptr);
+}
+
+TEST(BatchingFlatBufferCreatorTest, every_batch_is_separate) {
+  auto Creator = createBatching("100000", "100000");
+  auto First = Creator->createBatch();
+  auto Second = Creator->createBatch();
+  EpicsPVUpdate Update;
+  Update.channel = "channel";
+  ASSERT_EQ(First->add(Creator->create(Update)), nullptr);
+  ASSERT_EQ(Second->take(), nullptr);
+  ASSERT_NE(First->take(), nullptr);
+}
@@ -113,6 +113,88 @@ TEST(CommandHandlerTest, stop_command_removes_stream_correctly) {
   ASSERT_EQ(0u, Main.streams.size());
 }
 
+TEST(CommandHandlerTest, set_command_only_applies_the_difference) {
+  std::string AddJson = R"({
+                            "cmd": "add",
+                            "streams": [
+                              {
+                                "channel": "stopped_channel",
+                                "channel_provider_type": "ca"
+                              },
+                              {
+                                "channel": "kept_channel",
+                                "channel_provider_type": "ca"
+                              }
+                            ]
+                           })";
+
+  Forwarder::MainOpt MainOpt;
+  Forwarder::Forwarder Main(MainOpt);
+  Forwarder::ConfigCB Config(Main);
+
+  Config(AddJson);
+  auto KeptStream = Main.streams.getStreamByChannelName("kept_channel");
+  ASSERT_NE(nullptr, KeptStream);
+
+  std::string SetJson = R"({
+                            "cmd": "set",
+                            "streams": [
+                              {
+                                "channel": "kept_channel",
+                                "channel_provider_type": "ca"
+                              },
+                              {
+                                "channel": "new_channel",
+                                "channel_provider_type": "pva"
+                              }
+                            ]
+                           })";
+
+  Config(SetJson);
+
+  ASSERT_EQ(2u, Main.streams.size());
+  ASSERT_EQ(nullptr, Main.streams.getStreamByChannelName("stopped_channel"));
+  ASSERT_EQ(KeptStream, Main.streams.getStreamByChannelName("kept_channel"));
+  ASSERT_NE(nullptr, Main.streams.getStreamByChannelName("new_channel"));
+}
+
+TEST(CommandHandlerTest, set_command_restarts_changed_stream) {
+  std::string AddJson = R"({
+                            "cmd": "add",
+                            "streams": [
+                              {
+                                "channel": "my_channel_name",
+                                "channel_provider_type": "ca"
+                              }
+                            ]
+                           })";
+
+  Forwarder::MainOpt MainOpt;
+  Forwarder::Forwarder Main(MainOpt);
+  Forwarder::ConfigCB Config(Main);
+
+  Config(AddJson);
+  auto OldStream = Main.streams.getStreamByChannelName("my_channel_name");
+
+  std::string SetJson = R"({
+                            "cmd": "set",
+                            "streams": [
+                              {
+                                "channel": "my_channel_name",
+                                "channel_provider_type": "ca",
+                                "queue_size": 16
+                              }
+                            ]
+                           })";
+
+  Config(SetJson);
+
+  ASSERT_EQ(1u, Main.streams.size());
+  auto NewStream = Main.streams.getStreamByChannelName("my_channel_name");
+  ASSERT_NE(nullptr, NewStream);
+  ASSERT_NE(OldStream, NewStream);
+}
+
 class ExtractCommandsTest : public ::testing::TestWithParam<const char *> {
   void SetUp() override { command = (*GetParam()); }
   void TearDown() override {}
@@ -137,5 +219,6 @@ TEST_P(ExtractCommandsTest, extracting_command_gets_command_name) {
 }
 
 INSTANTIATE_TEST_CASE_P(InstantiationName, ExtractCommandsTest,
-                        ::testing::Values("add", "stop_channel", "stop_all",
-                                          "exit", "unknown_command"));
+                        ::testing::Values("add", "set", "stop_channel",
+                                          "stop_all", "exit",
+                                          "unknown_command"));
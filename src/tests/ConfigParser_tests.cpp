@@ -40,6 +40,26 @@ TEST(ConfigParserTest, trying_to_parse_invalid_json_throws) {
   ASSERT_ANY_THROW(Forwarder::ConfigParser Config(RawJson));
 }
 
+TEST(ConfigParserTest, parsed_json_gives_the_same_settings) {
+  std::string RawJson = R"({
+                            "streams": [
+                              {
+                                "channel": "my_channel_name",
+                                "channel_provider_type": "ca",
+                                "queue_size": 16
+                              }
+                            ]
+                           })";
+
+  Forwarder::ConfigParser Config(nlohmann::json::parse(RawJson));
+  auto Settings = Config.extractStreamInfo();
+
+  ASSERT_EQ(1u, Settings.StreamsInfo.size());
+  ASSERT_EQ("my_channel_name", Settings.StreamsInfo[0].Name);
+  ASSERT_EQ("ca", Settings.StreamsInfo[0].EpicsProtocol);
+  ASSERT_EQ(16u, Settings.StreamsInfo[0].QueueSize);
+}
+
 TEST(ConfigParserTest, no_streams_object_throws) {
   std::string RawJson = R"({
                             "streams": [1]
@@ -325,3 +345,175 @@ TEST(ConfigParserTest,
   ASSERT_EQ(fourth.HostPort, Settings.Brokers.at(3).HostPort);
   ASSERT_EQ(fifth.HostPort, Settings.Brokers.at(4).HostPort);
 }
+
+TEST(ConfigParserTest, extracting_streams_setting_gets_zero_copy_flag) {
+  std::string RawJson = R"({
+                            "streams": [
+                               {
+                                 "channel": "my_channel_name",
+                                 "zero_copy": true
+                               },
+                               {
+                                 "channel": "my_channel_name_2"
+                               }
+                            ]
+                           })";
+
+  Forwarder::ConfigParser Config(RawJson);
+  Forwarder::ConfigSettings Settings = Config.extractStreamInfo();
+
+  ASSERT_EQ(2u, Settings.StreamsInfo.size());
+  ASSERT_TRUE(Settings.StreamsInfo.at(0).ZeroCopy);
+  ASSERT_FALSE(Settings.StreamsInfo.at(1).ZeroCopy);
+}
+
+TEST(ConfigParserTest, extracting_streams_setting_gets_queue_size_and_policy) {
+  std::string RawJson = R"({
+                            "streams": [
+                               {
+                                 "channel": "my_channel_name",
+                                 "queue_size": 100,
+                                 "overflow_policy": "block"
+                               },
+                               {
+                                 "channel": "my_channel_name_2"
+                               }
+                            ]
+                           })";
+
+  Forwarder::ConfigParser Config(RawJson);
+  Forwarder::ConfigSettings Settings = Config.extractStreamInfo();
+
+  ASSERT_EQ(2u, Settings.StreamsInfo.size());
+  ASSERT_EQ(100u, Settings.StreamsInfo.at(0).QueueSize);
+  ASSERT_EQ(Forwarder::OverflowPolicy::Block,
+            Settings.StreamsInfo.at(0).Overflow);
+  ASSERT_EQ(0u, Settings.StreamsInfo.at(1).QueueSize);
+  ASSERT_EQ(Forwarder::OverflowPolicy::DropOldest,
+            Settings.StreamsInfo.at(1).Overflow);
+}
+
+TEST(ConfigParserTest, extracting_streams_setting_with_unknown_policy_throws) {
+  std::string RawJson = R"({
+                            "streams": [
+                               {
+                                 "channel": "my_channel_name",
+                                 "overflow_policy": "no_such_policy"
+                               }
+                            ]
+                           })";
+
+  Forwarder::ConfigParser Config(RawJson);
+  ASSERT_THROW(Config.extractStreamInfo(), Forwarder::MappingAddException);
+}
+
+TEST(ConfigParserTest, extracting_streams_setting_gets_coalesce_flag) {
+  std::string RawJson = R"({
+                            "streams": [
+                               {
+                                 "channel": "my_channel_name",
+                                 "coalesce": true
+                               },
+                               {
+                                 "channel": "my_channel_name_2"
+                               }
+                            ]
+                           })";
+
+  Forwarder::ConfigParser Config(RawJson);
+  Forwarder::ConfigSettings Settings = Config.extractStreamInfo();
+
+  ASSERT_EQ(2u, Settings.StreamsInfo.size());
+  ASSERT_TRUE(Settings.StreamsInfo.at(0).Coalesce);
+  ASSERT_FALSE(Settings.StreamsInfo.at(1).Coalesce);
+}
+
+TEST(ConfigParserTest, extracting_streams_setting_gets_filter_settings) {
+  std::string RawJson = R"({
+                            "streams": [
+                               {
+                                 "channel": "my_channel_name",
+                                 "filter": {
+                                   "deadband_absolute": 0.5,
+                                   "deadband_relative": 0.1,
+                                   "min_interval_ms": 20
+                                 }
+                               }
+                            ]
+                           })";
+
+  Forwarder::ConfigParser Config(RawJson);
+  Forwarder::ConfigSettings Settings = Config.extractStreamInfo();
+
+  ASSERT_EQ(1u, Settings.StreamsInfo.size());
+  auto const &Filter = Settings.StreamsInfo.at(0).Filter;
+  ASSERT_DOUBLE_EQ(0.5, Filter.DeadbandAbsolute);
+  ASSERT_DOUBLE_EQ(0.1, Filter.DeadbandRelative);
+  ASSERT_EQ(20u, Filter.MinIntervalMS);
+}
+
+TEST(ConfigParserTest, extracting_converter_settings_gets_converter_config) {
+  std::string RawJson = R"({
+                            "streams": [
+                               {
+                                 "channel": "my_channel_name",
+                                 "converter": {
+                                   "schema": "f142",
+                                   "topic": "my_topic",
+                                   "config": { "alarm": "on_change" }
+                                 }
+                               }
+                            ]
+                           })";
+
+  Forwarder::ConfigParser Config(RawJson);
+  Forwarder::ConfigSettings Settings = Config.extractStreamInfo();
+
+  auto const &Converter = Settings.StreamsInfo.at(0).Converters.at(0);
+  ASSERT_EQ(1u, Converter.Config.size());
+  ASSERT_EQ("on_change", Converter.Config.at("alarm"));
+}
+
+TEST(ConfigParserTest, extracting_converter_settings_gets_kafka_settings) {
+  std::string RawJson = R"({
+                            "streams": [
+                               {
+                                 "channel": "my_channel_name",
+                                 "converter": {
+                                   "schema": "f142",
+                                   "topic": "my_topic",
+                                   "kafka": {
+                                     "compression.codec": "lz4",
+                                     "linger.ms": 20
+                                   }
+                                 }
+                               }
+                            ]
+                           })";
+
+  Forwarder::ConfigParser Config(RawJson);
+  Forwarder::ConfigSettings Settings = Config.extractStreamInfo();
+
+  auto const &Converter = Settings.StreamsInfo.at(0).Converters.at(0);
+  ASSERT_EQ(2u, Converter.Kafka.size());
+  ASSERT_EQ("lz4", Converter.Kafka.at("compression.codec"));
+  ASSERT_EQ("20", Converter.Kafka.at("linger.ms"));
+}
+
+TEST(ConfigParserTest, converter_kafka_settings_which_are_no_object_throw) {
+  std::string RawJson = R"({
+                            "streams": [
+                               {
+                                 "channel": "my_channel_name",
+                                 "converter": {
+                                   "schema": "f142",
+                                   "topic": "my_topic",
+                                   "kafka": "lz4"
+                                 }
+                               }
+                            ]
+                           })";
+
+  Forwarder::ConfigParser Config(RawJson);
+  ASSERT_THROW(Config.extractStreamInfo(), Forwarder::MappingAddException);
+}
@@ -0,0 +1,85 @@
+#include "../ConversionWorker.h"
+#include "../Stream.h"
+#include "../Streams.h"
+#include "../helper.h"
+#include "StreamTestUtils.h"
+#include <chrono>
+#include <gtest/gtest.h>
+
+using namespace Forwarder;
+
+/// Converts a fixed backlog of updates with the given number of conversion
+/// threads.
+///
+/// \return The number of streams which still have updates queued.
+static size_t runConversions(size_t NumThreads, size_t NumStreams,
+                             size_t UpdatesPerStream,
+                             std::atomic<uint64_t> &Counter) {
+  Streams StreamList;
+  ConversionScheduler Scheduler(StreamList);
+  auto Update = std::make_shared<FlatBufs::EpicsPVUpdate>();
+  for (size_t i = 0; i < NumStreams; ++i) {
+    auto Queue = std::make_shared<PVUpdateQueue>(Scheduler.getWorkSignal());
+    ChannelInfo Info{"provider", "channel" + std::to_string(i)};
+    auto NewStream = std::make_shared<Stream>(
+        Info, std::make_shared<FakeEpicsClient>(), Queue);
+    auto Path = ::make_unique<FakeConversionPath>("topic" + std::to_string(i),
+                                                  "f142", &Counter);
+    Path->WorkPerUpdate = 500;
+    NewStream->addConverter(std::move(Path));
+    for (size_t j = 0; j < UpdatesPerStream; ++j) {
+      Queue->enqueue(Update);
+    }
+    StreamList.add(NewStream);
+  }
+  std::vector<std::unique_ptr<ConversionWorker>> Workers;
+  for (size_t i = 0; i < NumThreads; ++i) {
+    Workers.push_back(::make_unique<ConversionWorker>(&Scheduler, 1024));
+  }
+  uint64_t const Total = NumStreams * UpdatesPerStream;
+  auto Start = std::chrono::steady_clock::now();
+  for (auto &Worker : Workers) {
+    Worker->start();
+  }
+  while (Counter.load() < Total &&
+         std::chrono::steady_clock::now() - Start < std::chrono::seconds(30)) {
+    std::this_thread::sleep_for(std::chrono::microseconds(200));
+  }
+  for (auto &Worker : Workers) {
+    Worker->stop();
+  }
+  size_t NumNotDrained = 0;
+  for (auto const &Stream : *StreamList.getStreamsSnapshot()) {
+    if (Stream->getQueueSize() > 0) {
+      ++NumNotDrained;
+    }
+  }
+  return NumNotDrained;
+}
+
+TEST(ConversionSchedulerTest, every_update_is_converted_exactly_once) {
+  for (size_t NumThreads : {1u, 3u}) {
+    std::atomic<uint64_t> Counter{0};
+    ASSERT_EQ(runConversions(NumThreads, 10, 100, Counter), 0u);
+    ASSERT_EQ(Counter.load(), 1000u);
+  }
+}
+
+TEST(ConversionSchedulerTest, more_workers_than_streams_steal_work) {
+  std::atomic<uint64_t> Counter{0};
+  ASSERT_EQ(runConversions(8, 2, 500, Counter), 0u);
+  ASSERT_EQ(Counter.load(), 1000u);
+}
+
+/// With more streams than fit into a single refill, every shard has to be
+/// drained by its owner or stolen from by the others.
+TEST(ConversionSchedulerTest, all_shards_are_drained_for_any_thread_count) {
+  size_t const NumStreams = 256;
+  size_t const UpdatesPerStream = 400;
+  for (size_t NumThreads : {1u, 2u, 4u, 8u}) {
+    std::atomic<uint64_t> Counter{0};
+    ASSERT_EQ(
+        runConversions(NumThreads, NumStreams, UpdatesPerStream, Counter), 0u);
+    ASSERT_EQ(Counter.load(), NumStreams * UpdatesPerStream);
+  }
+}
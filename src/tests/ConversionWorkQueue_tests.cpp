@@ -0,0 +1,65 @@
+#include "../ConversionWorker.h"
+#include "../Stream.h"
+#include "../helper.h"
+#include "StreamTestUtils.h"
+#include <gtest/gtest.h>
+
+using namespace Forwarder;
+
+TEST(ConversionWorkQueueTest, packets_are_popped_in_the_order_of_push) {
+  ConversionWorkQueue Queue;
+  auto First = Queue.acquire();
+  auto Second = Queue.acquire();
+  Queue.push(First);
+  Queue.push(Second);
+  ASSERT_EQ(Queue.size(), 2u);
+  ASSERT_EQ(Queue.pop(), First);
+  ASSERT_EQ(Queue.pop(), Second);
+  ASSERT_EQ(Queue.pop(), nullptr);
+  Queue.release(First);
+  Queue.release(Second);
+}
+
+TEST(ConversionWorkQueueTest, released_packets_are_reused) {
+  ConversionWorkQueue Queue(1);
+  ASSERT_EQ(Queue.getNumAllocations(), 1u);
+  auto Packet = Queue.acquire();
+  Packet->up = std::make_shared<FlatBufs::EpicsPVUpdate>();
+  Queue.release(Packet);
+  ASSERT_EQ(Packet->up, nullptr);
+  ASSERT_EQ(Queue.acquire(), Packet);
+  ASSERT_EQ(Queue.getNumAllocations(), 1u);
+  Queue.release(Packet);
+}
+
+TEST(ConversionWorkQueueTest, forwarding_does_not_allocate_once_warmed_up) {
+  size_t const NumPaths = 2;
+  size_t const UpdatesPerRound = 100;
+  size_t const NumRounds = 1000;
+  auto UpdateQueue = std::make_shared<PVUpdateQueue>();
+  auto TestStream = std::make_shared<Stream>(
+      ChannelInfo{"provider", "channel"}, std::make_shared<FakeEpicsClient>(),
+      UpdateQueue);
+  for (size_t i = 0; i < NumPaths; ++i) {
+    TestStream->addConverter(
+        ::make_unique<FakeConversionPath>("topic" + std::to_string(i)));
+  }
+  ConversionWorkQueue Queue;
+  uint64_t AllocationsAfterFirstRound = 0;
+  for (size_t Round = 0; Round < NumRounds; ++Round) {
+    for (size_t i = 0; i < UpdatesPerRound; ++i) {
+      UpdateQueue->enqueue(std::make_shared<FlatBufs::EpicsPVUpdate>());
+    }
+    ASSERT_EQ(TestStream->fillConversionQueue(Queue, 1024),
+              NumPaths * UpdatesPerRound);
+    while (auto Packet = Queue.pop()) {
+      Packet->cp->emit(std::move(Packet->up));
+      Queue.release(Packet);
+    }
+    if (Round == 0) {
+      AllocationsAfterFirstRound = Queue.getNumAllocations();
+    }
+  }
+  ASSERT_EQ(Queue.getNumAllocations(), AllocationsAfterFirstRound);
+  ASSERT_EQ(UpdateQueue->sizeApprox(), 0u);
+}
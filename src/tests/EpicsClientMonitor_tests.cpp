@@ -12,8 +12,7 @@ TEST(EpicsClientMonitorTest,
 
   auto UpdatePtr = std::make_shared<FlatBufs::EpicsPVUpdate>();
 
-  auto PVUpdateRing = std::make_shared<
-      moodycamel::ConcurrentQueue<std::shared_ptr<FlatBufs::EpicsPVUpdate>>>();
+  auto PVUpdateRing = std::make_shared<PVUpdateQueue>();
   EpicsClient::EpicsClientMonitor Client(ChannelInfo, PVUpdateRing);
 
   // First emit the update
@@ -24,17 +23,17 @@ TEST(EpicsClientMonitorTest,
   Client.emitCachedValue();
 
   auto FirstValue = std::shared_ptr<FlatBufs::EpicsPVUpdate>();
-  ASSERT_TRUE(PVUpdateRing->try_dequeue(FirstValue));
+  ASSERT_TRUE(PVUpdateRing->tryDequeue(FirstValue));
 
   // There should be a second update in the buffer as the cached value should
   // have been emitted
   auto SecondValue = std::shared_ptr<FlatBufs::EpicsPVUpdate>();
-  ASSERT_TRUE(PVUpdateRing->try_dequeue(SecondValue));
+  ASSERT_TRUE(PVUpdateRing->tryDequeue(SecondValue));
 
   // There shouldn't be any values left in the ring buffer as just the update
   // and the cached value have been emitted.
   auto ThirdValue = std::shared_ptr<FlatBufs::EpicsPVUpdate>();
-  ASSERT_FALSE(PVUpdateRing->try_dequeue(ThirdValue));
+  ASSERT_FALSE(PVUpdateRing->tryDequeue(ThirdValue));
 }
 
 TEST(
@@ -46,20 +45,19 @@ TEST(
 
   auto UpdatePtr = std::make_shared<FlatBufs::EpicsPVUpdate>();
 
-  auto PVUpdateRing = std::make_shared<
-      moodycamel::ConcurrentQueue<std::shared_ptr<FlatBufs::EpicsPVUpdate>>>();
+  auto PVUpdateRing = std::make_shared<PVUpdateQueue>();
   EpicsClient::EpicsClientMonitor Client(ChannelInfo, PVUpdateRing);
 
   // First emit the update
   Client.emit(UpdatePtr);
 
   auto FirstValue = std::shared_ptr<FlatBufs::EpicsPVUpdate>();
-  ASSERT_TRUE(PVUpdateRing->try_dequeue(FirstValue));
+  ASSERT_TRUE(PVUpdateRing->tryDequeue(FirstValue));
 
   // There should not be a second update in the buffer as the cached value
   // should not have been emitted
   auto SecondValue = std::shared_ptr<FlatBufs::EpicsPVUpdate>();
-  ASSERT_FALSE(PVUpdateRing->try_dequeue(SecondValue));
+  ASSERT_FALSE(PVUpdateRing->tryDequeue(SecondValue));
 }
 
 TEST(EpicsClientMonitorTest,
@@ -70,8 +68,7 @@ TEST(EpicsClientMonitorTest,
 
   auto UpdatePtr = std::make_shared<FlatBufs::EpicsPVUpdate>();
 
-  auto PVUpdateRing = std::make_shared<
-      moodycamel::ConcurrentQueue<std::shared_ptr<FlatBufs::EpicsPVUpdate>>>();
+  auto PVUpdateRing = std::make_shared<PVUpdateQueue>();
   EpicsClient::EpicsClientMonitor Client(ChannelInfo, PVUpdateRing);
 
   // First emit the update
@@ -81,11 +78,11 @@ TEST(EpicsClientMonitorTest,
   ASSERT_NO_THROW(Client.emitCachedValue());
 
   auto FirstValue = std::shared_ptr<FlatBufs::EpicsPVUpdate>();
-  ASSERT_TRUE(PVUpdateRing->try_dequeue(FirstValue));
+  ASSERT_TRUE(PVUpdateRing->tryDequeue(FirstValue));
 
   // Should be empty as no cached update should have been pushed.
   auto SecondValue = std::shared_ptr<FlatBufs::EpicsPVUpdate>();
-  ASSERT_FALSE(PVUpdateRing->try_dequeue(SecondValue));
+  ASSERT_FALSE(PVUpdateRing->tryDequeue(SecondValue));
 }
 
 TEST(EpicsClientMonitorTest,
@@ -96,8 +93,7 @@ TEST(EpicsClientMonitorTest,
 
   auto UpdatePtr = std::make_shared<FlatBufs::EpicsPVUpdate>();
 
-  auto PVUpdateRing = std::make_shared<
-      moodycamel::ConcurrentQueue<std::shared_ptr<FlatBufs::EpicsPVUpdate>>>();
+  auto PVUpdateRing = std::make_shared<PVUpdateQueue>();
   EpicsClient::EpicsClientMonitor Client(ChannelInfo, PVUpdateRing);
 
   // Do not throw any exceptions when using a nullptr as the cached update
@@ -105,5 +101,33 @@ TEST(EpicsClientMonitorTest,
 
   // Should be empty as no cached update should have been pushed.
   auto FirstValue = std::shared_ptr<FlatBufs::EpicsPVUpdate>();
-  ASSERT_FALSE(PVUpdateRing->try_dequeue(FirstValue));
+  ASSERT_FALSE(PVUpdateRing->tryDequeue(FirstValue));
+}
+
+TEST(EpicsClientMonitorTest,
+     emitting_a_batch_pushes_all_updates_in_order_and_caches_the_last) {
+  ChannelInfo ChannelInfo;
+  ChannelInfo.channel_name = "SIM:Spd";
+  ChannelInfo.provider_type = "ca";
+
+  std::vector<std::shared_ptr<FlatBufs::EpicsPVUpdate>> Updates;
+  for (int i = 0; i < 3; ++i) {
+    Updates.push_back(std::make_shared<FlatBufs::EpicsPVUpdate>());
+  }
+
+  auto PVUpdateRing = std::make_shared<PVUpdateQueue>();
+  EpicsClient::EpicsClientMonitor Client(ChannelInfo, PVUpdateRing);
+
+  ASSERT_EQ(Client.emitBatch(Updates), 0);
+  Client.emitCachedValue();
+
+  for (auto const &Update : Updates) {
+    auto Value = std::shared_ptr<FlatBufs::EpicsPVUpdate>();
+    ASSERT_TRUE(PVUpdateRing->tryDequeue(Value));
+    ASSERT_EQ(Update, Value);
+  }
+  auto CachedValue = std::shared_ptr<FlatBufs::EpicsPVUpdate>();
+  ASSERT_TRUE(PVUpdateRing->tryDequeue(CachedValue));
+  ASSERT_EQ(Updates.back(), CachedValue);
+  ASSERT_FALSE(PVUpdateRing->tryDequeue(CachedValue));
 }
@@ -9,8 +9,7 @@ using namespace Forwarder;
 TEST(EpicsClientRandomTest,
      calling_GeneratePVUpdate_results_in_a_PV_update_in_the_buffer) {
   // GIVEN an EpicsClient with a ring buffer
-  auto RingBuffer = std::make_shared<
-      moodycamel::ConcurrentQueue<std::shared_ptr<FlatBufs::EpicsPVUpdate>>>();
+  auto RingBuffer = std::make_shared<PVUpdateQueue>();
   ChannelInfo ChannelInformation{"", ""};
   auto EpicsClient =
       EpicsClient::EpicsClientRandom(ChannelInformation, RingBuffer);
@@ -20,18 +19,17 @@ TEST(EpicsClientRandomTest,
 
   // THEN there will be a single EpicsPVUpdate in the ring buffer
   std::shared_ptr<FlatBufs::EpicsPVUpdate> FirstPV;
-  ASSERT_TRUE(RingBuffer->try_dequeue(FirstPV));
+  ASSERT_TRUE(RingBuffer->tryDequeue(FirstPV));
 
   // this time expect failure as only one should have been created
   std::shared_ptr<FlatBufs::EpicsPVUpdate> SecondPV;
-  ASSERT_FALSE(RingBuffer->try_dequeue(SecondPV));
+  ASSERT_FALSE(RingBuffer->tryDequeue(SecondPV));
 }
 
 TEST(EpicsClientRandomTest,
      calling_GeneratePVUpdate_results_in_different_PV_values) {
   // GIVEN an EpicsClient with a ring buffer
-  auto RingBuffer = std::make_shared<
-      moodycamel::ConcurrentQueue<std::shared_ptr<FlatBufs::EpicsPVUpdate>>>();
+  auto RingBuffer = std::make_shared<PVUpdateQueue>();
   ChannelInfo ChannelInformation{"", ""};
   auto EpicsClient =
       EpicsClient::EpicsClientRandom(ChannelInformation, RingBuffer);
@@ -43,9 +41,9 @@ TEST(EpicsClientRandomTest,
   // THEN there will be two EpicsPVUpdates in the ring buffer with different
   // values
   std::shared_ptr<FlatBufs::EpicsPVUpdate> FirstPV;
-  ASSERT_TRUE(RingBuffer->try_dequeue(FirstPV));
+  ASSERT_TRUE(RingBuffer->tryDequeue(FirstPV));
   std::shared_ptr<FlatBufs::EpicsPVUpdate> SecondPV;
-  ASSERT_TRUE(RingBuffer->try_dequeue(SecondPV));
+  ASSERT_TRUE(RingBuffer->tryDequeue(SecondPV));
 
   double FirstGeneratedPVValue =
       FirstPV->epics_pvstr->getSubField<epics::pvData::PVDouble>("value")
@@ -62,8 +60,7 @@ TEST(EpicsClientRandomTest,
 TEST(EpicsClientRandomTest,
      generated_pv_updates_have_populated_and_nonzero_timestamp_fields) {
   // GIVEN an EpicsClient with a ring buffer
-  auto RingBuffer = std::make_shared<
-      moodycamel::ConcurrentQueue<std::shared_ptr<FlatBufs::EpicsPVUpdate>>>();
+  auto RingBuffer = std::make_shared<PVUpdateQueue>();
   ChannelInfo ChannelInformation{"", ""};
   auto EpicsClient =
       EpicsClient::EpicsClientRandom(ChannelInformation, RingBuffer);
@@ -74,7 +71,7 @@ TEST(EpicsClientRandomTest,
   // THEN there will be an EpicsPVUpdates in the ring buffer with timestamp
   // fields
   std::shared_ptr<FlatBufs::EpicsPVUpdate> FirstPV;
-  ASSERT_TRUE(RingBuffer->try_dequeue(FirstPV));
+  ASSERT_TRUE(RingBuffer->tryDequeue(FirstPV));
 
   auto PvTimeStamp =
       FirstPV->epics_pvstr->getSubField<epics::pvData::PVStructure>(
@@ -0,0 +1,41 @@
+#include "../FlatBufferBuilderPool.h"
+#include <gtest/gtest.h>
+
+using namespace FlatBufs;
+
+TEST(FlatBufferBuilderPoolTest, released_message_is_reused) {
+  auto Pool = std::make_shared<FlatBufferBuilderPool>();
+  auto Message = Pool->acquire();
+  auto Pointer = Message.get();
+  Message->builder->Finish(Message->builder->CreateString("some data"));
+  Message.release()->release();
+
+  auto Reused = Pool->acquire();
+  ASSERT_EQ(Reused.get(), Pointer);
+  ASSERT_EQ(Reused->builder->GetSize(), 0u);
+  ASSERT_EQ(Pool->getNumAllocations(), 1u);
+}
+
+TEST(FlatBufferBuilderPoolTest, new_builders_start_with_largest_seen_size) {
+  auto Pool = std::make_shared<FlatBufferBuilderPool>();
+  auto Message = Pool->acquire();
+  std::vector<uint8_t> Data(5000);
+  Message->builder->Finish(Message->builder->CreateVector(Data));
+  auto Size = Message->builder->GetSize();
+  Message.release()->release();
+  ASSERT_EQ(Pool->getInitialSize(), Size);
+}
+
+TEST(FlatBufferBuilderPoolTest, message_outlives_pool) {
+  auto Pool = std::make_shared<FlatBufferBuilderPool>();
+  auto Message = Pool->acquire();
+  Pool.reset();
+  Message->builder->Finish(Message->builder->CreateString("some data"));
+  // Returns the message to the pool which is then destroyed
+  Message.release()->release();
+}
+
+TEST(FlatBufferBuilderPoolTest, unpooled_message_is_deleted_on_release) {
+  auto Message = new FlatbufferMessage();
+  Message->release();
+}
@@ -0,0 +1,203 @@
+#include "../BatchedOutput.h"
+#include "../KafkaOutput.h"
+#include "../helper.h"
+#include "MockProducer.h"
+#include <cstring>
+#include <gtest/gtest.h>
+
+using namespace Forwarder;
+using ::testing::_;
+using ::testing::Invoke;
+
+/// Gives access to the handle so that it can be replaced by a mock.
+class MockableProducer : public KafkaW::Producer {
+public:
+  explicit MockableProducer(KafkaW::BrokerSettings const &Settings)
+      : Producer(Settings) {}
+  using Producer::ProducerPtr;
+};
+
+/// Takes the message like librdkafka and delivers it right away.
+static RdKafka::ErrorCode deliver(RdKafka::Topic *, int32_t, int, void *,
+                                  size_t, const void *, size_t,
+                                  void *Opaque) {
+  static_cast<KafkaW::ProducerMessage *>(Opaque)->release();
+  return RdKafka::ERR_NO_ERROR;
+}
+
+class KafkaOutputTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    Producer = std::make_shared<MockableProducer>(KafkaW::BrokerSettings{});
+    // The topic is created with the real handle, which has to outlive it
+    Output = ::make_unique<KafkaOutput>(
+        KafkaW::ProducerTopic(Producer, "topic"), "channel");
+    RealHandle = std::move(Producer->ProducerPtr);
+    Mock = new MockProducer;
+    Producer->ProducerPtr.reset(Mock);
+  }
+
+  void TearDown() override {
+    Output.reset();
+    Producer->ProducerPtr = std::move(RealHandle);
+  }
+
+  /// \return A message whose payload is the given number.
+  static std::unique_ptr<FlatBufs::FlatbufferMessage>
+  createMessage(uint32_t Number) {
+    auto Message = ::make_unique<FlatBufs::FlatbufferMessage>();
+    Message->builder->Finish(Message->builder->CreateVector(
+        std::vector<uint32_t>{Number}));
+    return Message;
+  }
+
+  std::shared_ptr<MockableProducer> Producer;
+  std::unique_ptr<RdKafka::Handle> RealHandle;
+  MockProducer *Mock = nullptr;
+  std::unique_ptr<KafkaOutput> Output;
+};
+
+TEST_F(KafkaOutputTest, messages_are_keyed_and_partitioned_by_librdkafka) {
+  std::string Key;
+  EXPECT_CALL(*Mock, produce(_, RdKafka::Topic::PARTITION_UA, _, _, _, _, _,
+                             _))
+      .Times(2)
+      .WillRepeatedly(
+          Invoke([&Key](RdKafka::Topic *Topic, int32_t Partition, int Flags,
+                        void *Payload, size_t Size, const void *KeyData,
+                        size_t KeySize, void *Opaque) {
+            Key.assign(static_cast<char const *>(KeyData), KeySize);
+            return deliver(Topic, Partition, Flags, Payload, Size, KeyData,
+                           KeySize, Opaque);
+          }));
+  ASSERT_EQ(Output->emit(createMessage(1)), 0);
+  ASSERT_EQ(Output->emit(createMessage(2)), 0);
+  ASSERT_EQ(Key, "channel");
+}
+
+/// Payload numbers of the produced messages while the queue of librdkafka
+/// is not full.
+class RecordingProducer {
+public:
+  explicit RecordingProducer(MockProducer &Mock) {
+    ON_CALL(Mock, produce(_, _, _, _, _, _, _, _))
+        .WillByDefault(Invoke(
+            [this](RdKafka::Topic *Topic, int32_t Partition, int Flags,
+                   void *Payload, size_t Size, const void *KeyData,
+                   size_t KeySize, void *Opaque) {
+              if (QueueFull) {
+                return RdKafka::ERR__QUEUE_FULL;
+              }
+              Produced.push_back(
+                  flatbuffers::GetRoot<flatbuffers::Vector<uint32_t>>(Payload)
+                      ->Get(0));
+              return deliver(Topic, Partition, Flags, Payload, Size, KeyData,
+                             KeySize, Opaque);
+            }));
+    EXPECT_CALL(Mock, produce(_, _, _, _, _, _, _, _))
+        .Times(::testing::AnyNumber());
+  }
+  bool QueueFull = false;
+  std::vector<uint32_t> Produced;
+};
+
+TEST_F(KafkaOutputTest, backlog_is_sent_before_newer_messages) {
+  RecordingProducer Recorder(*Mock);
+  Recorder.QueueFull = true;
+  for (uint32_t i = 1; i <= 3; ++i) {
+    ASSERT_EQ(Output->emit(createMessage(i)), KafkaW::ProduceQueueFull);
+  }
+  ASSERT_EQ(Output->getBacklogSize(), 3u);
+
+  Recorder.QueueFull = false;
+  ASSERT_EQ(Output->emit(createMessage(4)), 0);
+  ASSERT_EQ(Recorder.Produced, (std::vector<uint32_t>{1, 2, 3, 4}));
+  ASSERT_EQ(Output->getBacklogSize(), 0u);
+  ASSERT_EQ(Output->getNumRetried(), 3u);
+  ASSERT_EQ(Output->getNumDropped(), 0u);
+}
+
+TEST_F(KafkaOutputTest, retry_sends_the_backlog_once_kafka_has_room) {
+  RecordingProducer Recorder(*Mock);
+  Recorder.QueueFull = true;
+  Output->emit(createMessage(1));
+  Output->emit(createMessage(2));
+  ASSERT_FALSE(Output->retryBacklog());
+  ASSERT_EQ(Output->getNumRetried(), 0u);
+
+  Recorder.QueueFull = false;
+  ASSERT_TRUE(Output->retryBacklog());
+  ASSERT_EQ(Recorder.Produced, (std::vector<uint32_t>{1, 2}));
+  ASSERT_EQ(Output->getNumRetried(), 2u);
+  ASSERT_TRUE(Output->retryBacklog());
+}
+
+TEST_F(KafkaOutputTest, full_backlog_drops_the_oldest_message) {
+  RecordingProducer Recorder(*Mock);
+  Recorder.QueueFull = true;
+  auto NumMessages = static_cast<uint32_t>(KafkaOutput::MaxBacklog + 1);
+  for (uint32_t i = 0; i < NumMessages; ++i) {
+    Output->emit(createMessage(i));
+  }
+  ASSERT_EQ(Output->getBacklogSize(), KafkaOutput::MaxBacklog);
+  ASSERT_EQ(Output->getNumDropped(), 1u);
+
+  Recorder.QueueFull = false;
+  ASSERT_TRUE(Output->retryBacklog());
+  ASSERT_EQ(Recorder.Produced.size(), KafkaOutput::MaxBacklog);
+  ASSERT_EQ(Recorder.Produced.front(), 1u);
+  ASSERT_EQ(Recorder.Produced.back(), NumMessages - 1);
+}
+
+TEST_F(KafkaOutputTest, failed_message_is_dropped_and_counted) {
+  EXPECT_CALL(*Mock, produce(_, _, _, _, _, _, _, _))
+      .WillOnce(::testing::Return(RdKafka::ERR_MSG_SIZE_TOO_LARGE));
+  auto Result = Output->emit(createMessage(1));
+  ASSERT_NE(Result, 0);
+  ASSERT_NE(Result, KafkaW::ProduceQueueFull);
+  ASSERT_EQ(Output->getNumDropped(), 1u);
+  ASSERT_EQ(Output->getBacklogSize(), 0u);
+}
+
+TEST_F(KafkaOutputTest, batched_output_sends_messages_of_its_paths_together) {
+  std::vector<uint32_t> NumEntries;
+  EXPECT_CALL(*Mock, produce(_, _, _, _, _, _, _, _))
+      .WillOnce(
+          Invoke([&NumEntries](RdKafka::Topic *Topic, int32_t Partition,
+                               int Flags, void *Payload, size_t Size,
+                               const void *KeyData, size_t KeySize,
+                               void *Opaque) {
+            uint32_t Number = 0;
+            std::memcpy(&Number, Payload, sizeof(Number));
+            NumEntries.push_back(Number);
+            return deliver(Topic, Partition, Flags, Payload, Size, KeyData,
+                           KeySize, Opaque);
+          }));
+  auto Batched = std::make_shared<BatchedOutput>(
+      ::make_unique<FlatBufs::MessageBatch>(
+          100000, std::chrono::milliseconds(100000),
+          std::make_shared<FlatBufs::BatchCounters>()),
+      std::move(Output));
+  // Two conversion paths which share the output
+  auto First = Batched;
+  auto Second = Batched;
+  Batched.reset();
+  First->emit(createMessage(1));
+  Second->emit(createMessage(2));
+  ASSERT_EQ(First->flush(false), 0);
+  First.reset();
+  ASSERT_TRUE(NumEntries.empty());
+  // The last path sends the pending batch
+  Second.reset();
+  ASSERT_EQ(NumEntries, (std::vector<uint32_t>{2}));
+}
+
+TEST_F(KafkaOutputTest, topics_are_counted_by_their_producer) {
+  ASSERT_EQ(Producer->NumTopics.load(), 1u);
+  // The moved from topic does not count
+  auto Moved = ::make_unique<KafkaOutput>(std::move(*Output));
+  Output.reset();
+  ASSERT_EQ(Producer->NumTopics.load(), 1u);
+  Moved.reset();
+  ASSERT_EQ(Producer->NumTopics.load(), 0u);
+}
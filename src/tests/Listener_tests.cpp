@@ -15,6 +15,22 @@ public:
   };
   void addTopic(const std::string &Topic) override { UNUSED_ARG(Topic); };
 };
+
+/// Has a few commands waiting, then the topic is empty.
+class ConsumerWithCommands : public ConsumerInterface {
+public:
+  std::unique_ptr<ConsumerMessage> poll() override {
+    ++NumPolls;
+    if (NumPolls > 3) {
+      return make_unique<KafkaW::ConsumerMessage>(KafkaW::PollStatus::Empty);
+    }
+    std::string Data = R"({"cmd": "unknown_command"})";
+    return make_unique<KafkaW::ConsumerMessage>(Data,
+                                                KafkaW::PollStatus::Message);
+  };
+  void addTopic(const std::string &Topic) override { UNUSED_ARG(Topic); };
+  size_t NumPolls{0};
+};
 }
 
 TEST(ListenerTest, successfully_create_listener_and_poll) {
@@ -28,3 +44,16 @@ TEST(ListenerTest, successfully_create_listener_and_poll) {
   Forwarder::ConfigCB config_cb(ForwarderInstance);
   ASSERT_NO_THROW(listener.poll(config_cb));
 }
+
+TEST(ListenerTest, poll_handles_all_waiting_commands) {
+  auto Consumer = make_unique<KafkaW::ConsumerWithCommands>();
+  auto ConsumerPtr = Consumer.get();
+
+  Forwarder::URI uri;
+  Forwarder::Config::Listener listener(uri, std::move(Consumer));
+  Forwarder::MainOpt Options;
+  Forwarder::Forwarder ForwarderInstance(Options);
+  Forwarder::ConfigCB config_cb(ForwarderInstance);
+  listener.poll(config_cb);
+  ASSERT_EQ(4u, ConsumerPtr->NumPolls);
+}
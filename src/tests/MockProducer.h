@@ -0,0 +1,46 @@
+#pragma once
+#include <gmock/gmock.h>
+#include <librdkafka/rdkafkacpp.h>
+
+class MockProducer : public RdKafka::Producer {
+public:
+  MOCK_CONST_METHOD0(name, const std::string());
+  MOCK_CONST_METHOD0(memberid, const std::string());
+  MOCK_METHOD1(poll, int(int));
+  MOCK_METHOD0(outq_len, int());
+  MOCK_METHOD4(metadata, RdKafka::ErrorCode(bool, const RdKafka::Topic *,
+                                            RdKafka::Metadata **, int));
+  MOCK_METHOD1(pause,
+               RdKafka::ErrorCode(std::vector<RdKafka::TopicPartition *> &));
+  MOCK_METHOD1(resume,
+               RdKafka::ErrorCode(std::vector<RdKafka::TopicPartition *> &));
+  MOCK_METHOD5(query_watermark_offsets,
+               RdKafka::ErrorCode(const std::string &, int32_t, int64_t *,
+                                  int64_t *, int));
+  MOCK_METHOD4(get_watermark_offsets,
+               RdKafka::ErrorCode(const std::string &, int32_t, int64_t *,
+                                  int64_t *));
+  MOCK_METHOD2(offsetsForTimes,
+               RdKafka::ErrorCode(std::vector<RdKafka::TopicPartition *> &,
+                                  int));
+  MOCK_METHOD1(get_partition_queue,
+               RdKafka::Queue *(const RdKafka::TopicPartition *));
+  MOCK_METHOD1(set_log_queue, RdKafka::ErrorCode(RdKafka::Queue *));
+  MOCK_METHOD0(yield, void());
+  MOCK_METHOD1(clusterid, const std::string(int));
+  MOCK_METHOD0(c_ptr, rd_kafka_s *());
+  MOCK_METHOD2(create, RdKafka::Producer *(RdKafka::Conf *, std::string));
+  MOCK_METHOD7(produce,
+               RdKafka::ErrorCode(RdKafka::Topic *, int32_t, int, void *,
+                                  size_t, const std::string *, void *));
+  MOCK_METHOD8(produce,
+               RdKafka::ErrorCode(RdKafka::Topic *, int32_t, int, void *,
+                                  size_t, const void *, size_t, void *));
+  MOCK_METHOD9(produce, RdKafka::ErrorCode(const std::string, int32_t, int,
+                                           void *, size_t, const void *, size_t,
+                                           int64_t, void *));
+  MOCK_METHOD5(produce, RdKafka::ErrorCode(RdKafka::Topic *, int32_t,
+                                           const std::vector<char> *,
+                                           const std::vector<char> *, void *));
+  MOCK_METHOD1(flush, RdKafka::ErrorCode(int));
+};
@@ -0,0 +1,185 @@
+#include "../PVUpdateQueue.h"
+#include <atomic>
+#include <chrono>
+#include <gtest/gtest.h>
+#include <thread>
+
+using namespace Forwarder;
+
+TEST(PVUpdateQueueTest, updates_enqueued_with_token_are_dequeued_in_order) {
+  PVUpdateQueue Queue;
+  auto Token = Queue.createProducerToken();
+  auto First = std::make_shared<FlatBufs::EpicsPVUpdate>();
+  auto Second = std::make_shared<FlatBufs::EpicsPVUpdate>();
+  ASSERT_TRUE(Queue.enqueue(Token, First));
+  ASSERT_TRUE(Queue.enqueue(Token, Second));
+
+  auto ConsumerToken = Queue.createConsumerToken();
+  std::vector<std::shared_ptr<FlatBufs::EpicsPVUpdate>> Updates(4);
+  ASSERT_EQ(Queue.tryDequeueBulk(ConsumerToken, Updates.data(), 4), 2u);
+  ASSERT_EQ(Updates[0], First);
+  ASSERT_EQ(Updates[1], Second);
+}
+
+TEST(PVUpdateQueueTest, bulk_enqueue_adds_all_updates) {
+  PVUpdateQueue Queue;
+  auto Token = Queue.createProducerToken();
+  std::vector<std::shared_ptr<FlatBufs::EpicsPVUpdate>> Updates(3);
+  for (auto &Update : Updates) {
+    Update = std::make_shared<FlatBufs::EpicsPVUpdate>();
+  }
+  ASSERT_TRUE(Queue.enqueueBulk(Token, Updates));
+  ASSERT_EQ(Queue.sizeApprox(), 3u);
+}
+
+/// Enqueues Count distinct updates.
+static std::vector<std::shared_ptr<FlatBufs::EpicsPVUpdate>>
+fillQueue(PVUpdateQueue &Queue, size_t Count) {
+  std::vector<std::shared_ptr<FlatBufs::EpicsPVUpdate>> Updates;
+  for (size_t i = 0; i < Count; ++i) {
+    Updates.push_back(std::make_shared<FlatBufs::EpicsPVUpdate>());
+    Queue.enqueue(Updates.back());
+  }
+  return Updates;
+}
+
+TEST(PVUpdateQueueTest, drop_oldest_keeps_the_newest_updates) {
+  PVUpdateQueue Queue(nullptr, 2, OverflowPolicy::DropOldest);
+  auto Updates = fillQueue(Queue, 3);
+  ASSERT_EQ(Queue.sizeApprox(), 2u);
+  std::shared_ptr<FlatBufs::EpicsPVUpdate> Update;
+  ASSERT_TRUE(Queue.tryDequeue(Update));
+  ASSERT_EQ(Update, Updates[1]);
+  ASSERT_TRUE(Queue.tryDequeue(Update));
+  ASSERT_EQ(Update, Updates[2]);
+  ASSERT_EQ(Queue.getStatusJson()["dropped_oldest"], 1u);
+}
+
+TEST(PVUpdateQueueTest, drop_newest_keeps_the_oldest_updates) {
+  PVUpdateQueue Queue(nullptr, 2, OverflowPolicy::DropNewest);
+  auto Updates = fillQueue(Queue, 3);
+  ASSERT_EQ(Queue.sizeApprox(), 2u);
+  std::shared_ptr<FlatBufs::EpicsPVUpdate> Update;
+  ASSERT_TRUE(Queue.tryDequeue(Update));
+  ASSERT_EQ(Update, Updates[0]);
+  ASSERT_TRUE(Queue.tryDequeue(Update));
+  ASSERT_EQ(Update, Updates[1]);
+  ASSERT_EQ(Queue.getStatusJson()["dropped_newest"], 1u);
+}
+
+TEST(PVUpdateQueueTest, block_waits_until_there_is_room) {
+  PVUpdateQueue Queue(nullptr, 1, OverflowPolicy::Block);
+  fillQueue(Queue, 1);
+  std::atomic<bool> Enqueued{false};
+  std::thread Producer([&Queue, &Enqueued]() {
+    Queue.enqueue(std::make_shared<FlatBufs::EpicsPVUpdate>());
+    Enqueued = true;
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  ASSERT_FALSE(Enqueued);
+  std::shared_ptr<FlatBufs::EpicsPVUpdate> Update;
+  ASSERT_TRUE(Queue.tryDequeue(Update));
+  Producer.join();
+  ASSERT_TRUE(Enqueued);
+  ASSERT_EQ(Queue.sizeApprox(), 1u);
+  ASSERT_EQ(Queue.getStatusJson()["blocked"], 1u);
+}
+
+TEST(PVUpdateQueueTest, block_drops_the_update_after_the_maximum_wait) {
+  PVUpdateQueue Queue(nullptr, 1, OverflowPolicy::Block);
+  auto Updates = fillQueue(Queue, 1);
+  auto Start = std::chrono::steady_clock::now();
+  ASSERT_FALSE(Queue.enqueue(std::make_shared<FlatBufs::EpicsPVUpdate>()));
+  ASSERT_GE(std::chrono::steady_clock::now() - Start,
+            PVUpdateQueue::MaxBlockTime);
+  std::shared_ptr<FlatBufs::EpicsPVUpdate> Update;
+  ASSERT_TRUE(Queue.tryDequeue(Update));
+  ASSERT_EQ(Update, Updates[0]);
+  ASSERT_EQ(Queue.getStatusJson()["dropped_newest"], 1u);
+}
+
+TEST(PVUpdateQueueTest, coalesce_mode_keeps_only_the_latest_update) {
+  PVUpdateQueue Queue(nullptr, 0, OverflowPolicy::DropOldest, true);
+  auto Updates = fillQueue(Queue, 3);
+  ASSERT_EQ(Queue.sizeApprox(), 1u);
+  auto Token = Queue.createConsumerToken();
+  std::vector<std::shared_ptr<FlatBufs::EpicsPVUpdate>> Dequeued(4);
+  ASSERT_EQ(Queue.tryDequeueBulk(Token, Dequeued.data(), 4), 1u);
+  ASSERT_EQ(Dequeued[0], Updates[2]);
+  ASSERT_EQ(Queue.sizeApprox(), 0u);
+  ASSERT_EQ(Queue.tryDequeueBulk(Token, Dequeued.data(), 4), 0u);
+  ASSERT_EQ(Queue.getStatusJson()["coalesced"], 2u);
+}
+
+TEST(PVUpdateQueueTest, coalesce_mode_bulk_enqueue_keeps_the_last_update) {
+  PVUpdateQueue Queue(nullptr, 0, OverflowPolicy::DropOldest, true);
+  auto Token = Queue.createProducerToken();
+  std::vector<std::shared_ptr<FlatBufs::EpicsPVUpdate>> Updates(3);
+  for (auto &Update : Updates) {
+    Update = std::make_shared<FlatBufs::EpicsPVUpdate>();
+  }
+  ASSERT_TRUE(Queue.enqueueBulk(Token, Updates));
+  std::shared_ptr<FlatBufs::EpicsPVUpdate> Update;
+  ASSERT_TRUE(Queue.tryDequeue(Update));
+  ASSERT_EQ(Update, Updates[2]);
+  ASSERT_EQ(Queue.getStatusJson()["coalesced"], 2u);
+}
+
+TEST(PVUpdateQueueTest, close_releases_blocked_producer) {
+  PVUpdateQueue Queue(nullptr, 1, OverflowPolicy::Block);
+  fillQueue(Queue, 1);
+  std::thread Producer([&Queue]() {
+    ASSERT_FALSE(Queue.enqueue(std::make_shared<FlatBufs::EpicsPVUpdate>()));
+  });
+  Queue.close();
+  Producer.join();
+  ASSERT_EQ(Queue.sizeApprox(), 1u);
+}
+
+/// Moves Count updates from two producer threads through the queue, like the
+/// EPICS monitor and the PV update timer do.
+///
+/// \return Whether all updates arrived exactly once and, for each producer,
+/// in the order they were enqueued.
+static bool runProducers(bool UseTokens, uint64_t Count) {
+  PVUpdateQueue Queue;
+  auto Produce = [&Queue, UseTokens, Count](uint64_t ProducerID) {
+    auto Token = Queue.createProducerToken();
+    for (uint64_t i = 0; i < Count; ++i) {
+      auto Update = std::make_shared<FlatBufs::EpicsPVUpdate>();
+      Update->ts_epics_monitor = ProducerID * Count + i;
+      if (UseTokens) {
+        Queue.enqueue(Token, Update);
+      } else {
+        Queue.enqueue(Update);
+      }
+    }
+  };
+  std::thread Monitor(Produce, 0);
+  std::thread Timer(Produce, 1);
+  auto ConsumerToken = Queue.createConsumerToken();
+  std::vector<std::shared_ptr<FlatBufs::EpicsPVUpdate>> Buffer(1024);
+  uint64_t Expected[2] = {0, Count};
+  uint64_t NumDequeued = 0;
+  bool InOrder = true;
+  while (NumDequeued < 2 * Count) {
+    auto Dequeued =
+        Queue.tryDequeueBulk(ConsumerToken, Buffer.data(), Buffer.size());
+    for (size_t i = 0; i < Dequeued; ++i) {
+      auto Value = Buffer[i]->ts_epics_monitor;
+      auto &Next = Expected[Value / Count];
+      InOrder = InOrder && Value == Next;
+      Next = Value + 1;
+    }
+    NumDequeued += Dequeued;
+  }
+  Monitor.join();
+  Timer.join();
+  return InOrder && Queue.sizeApprox() == 0;
+}
+
+TEST(PVUpdateQueueTest, implicit_and_explicit_producers_keep_the_order) {
+  uint64_t const Count = 200000;
+  ASSERT_TRUE(runProducers(false, Count));
+  ASSERT_TRUE(runProducers(true, Count));
+}
@@ -62,4 +62,48 @@ TEST_F(ProducerDeliveryCbTests,
   ASSERT_TRUE(Called);
   EXPECT_EQ(Stats.produce_cb, 0);
   EXPECT_EQ(Stats.produce_cb_fail, 1);
-}
\ No newline at end of file
+}
+TEST_F(ProducerDeliveryCbTests, deliveryCbRecordsLatencyOfStampedMessages) {
+  bool Called = false;
+
+  ProducerMessageStandIn *FakeMessage =
+      new ProducerMessageStandIn([&Called]() { Called = true; });
+  FakeMessage->ProduceTime =
+      std::chrono::steady_clock::now() - std::chrono::milliseconds(3);
+  MockMessage Message;
+  RdKafka::Message *TempPtr = reinterpret_cast<RdKafka::Message *>(&Message);
+  EXPECT_CALL(Message, err())
+      .Times(Exactly(1))
+      .WillOnce(Return(RdKafka::ErrorCode::ERR_NO_ERROR));
+  EXPECT_CALL(Message, msg_opaque())
+      .Times(Exactly(1))
+      .WillOnce(Return(reinterpret_cast<void *>(FakeMessage)));
+  ProducerStats Stats;
+  ProducerDeliveryCb Callback(Stats);
+  Callback.dr_cb(*TempPtr);
+  ASSERT_TRUE(Called);
+  uint64_t Total = 0;
+  for (size_t Bucket = 0; Bucket < 2; ++Bucket) {
+    Total += Stats.delivery_latency.Counts[Bucket];
+  }
+  EXPECT_EQ(Total, 0u);
+  for (auto const &Count : Stats.delivery_latency.Counts) {
+    Total += Count;
+  }
+  EXPECT_EQ(Total, 1u);
+}
+
+TEST_F(ProducerDeliveryCbTests, latencyHistogramBucketsDoubleInSize) {
+  LatencyHistogram Histogram;
+  Histogram.add(std::chrono::microseconds(500));
+  Histogram.add(std::chrono::milliseconds(1));
+  Histogram.add(std::chrono::milliseconds(3));
+  Histogram.add(std::chrono::hours(1));
+  EXPECT_EQ(Histogram.Counts[0], 1u);
+  EXPECT_EQ(Histogram.Counts[1], 1u);
+  EXPECT_EQ(Histogram.Counts[2], 1u);
+  EXPECT_EQ(Histogram.Counts[LatencyHistogram::NumBuckets - 1], 1u);
+  EXPECT_EQ(LatencyHistogram::upperBoundMS(2), 4u);
+  EXPECT_EQ(LatencyHistogram::upperBoundMS(LatencyHistogram::NumBuckets - 1),
+            0u);
+}
@@ -0,0 +1,78 @@
+#include "../StateSnapshot.h"
+#include <cstdio>
+#include <gtest/gtest.h>
+
+using namespace Forwarder;
+
+static std::vector<StreamSettings> createSettings() {
+  StreamSettings Stream;
+  Stream.Name = "SIMPLE:DOUBLE";
+  Stream.EpicsProtocol = "ca";
+  Stream.ZeroCopy = true;
+  Stream.QueueSize = 100;
+  Stream.Overflow = OverflowPolicy::Block;
+  Stream.Filter.DeadbandAbsolute = 0.5;
+  Stream.Filter.MinIntervalMS = 20;
+  ConverterSettings Converter;
+  Converter.Schema = "f142";
+  Converter.Topic = "//localhost:9092/some_topic";
+  Converter.Name = "converter_0";
+  Converter.Config["alarm"] = "on_change";
+  Converter.Kafka["linger.ms"] = "20";
+  Stream.Converters.push_back(Converter);
+  StreamSettings Other;
+  Other.Name = "SIMPLE:LONG";
+  Other.EpicsProtocol = "pva";
+  return {Stream, Other};
+}
+
+TEST(StateSnapshotTest, deserialize_restores_serialized_streams) {
+  auto Image = StateSnapshot::serialize(createSettings());
+  auto Streams = StateSnapshot::deserialize(Image.data(), Image.size());
+
+  ASSERT_EQ(2u, Streams.size());
+  auto const &Stream = Streams.at(0);
+  ASSERT_EQ("SIMPLE:DOUBLE", Stream.Name);
+  ASSERT_EQ("ca", Stream.EpicsProtocol);
+  ASSERT_TRUE(Stream.ZeroCopy);
+  ASSERT_EQ(100u, Stream.QueueSize);
+  ASSERT_EQ(OverflowPolicy::Block, Stream.Overflow);
+  ASSERT_FALSE(Stream.Coalesce);
+  ASSERT_DOUBLE_EQ(0.5, Stream.Filter.DeadbandAbsolute);
+  ASSERT_EQ(20u, Stream.Filter.MinIntervalMS);
+  ASSERT_EQ(1u, Stream.Converters.size());
+  auto const &Converter = Stream.Converters.at(0);
+  ASSERT_EQ("f142", Converter.Schema);
+  ASSERT_EQ("//localhost:9092/some_topic", Converter.Topic);
+  ASSERT_EQ("converter_0", Converter.Name);
+  ASSERT_EQ("on_change", Converter.Config.at("alarm"));
+  ASSERT_EQ("20", Converter.Kafka.at("linger.ms"));
+  ASSERT_EQ("SIMPLE:LONG", Streams.at(1).Name);
+  ASSERT_TRUE(Streams.at(1).Converters.empty());
+}
+
+TEST(StateSnapshotTest, truncated_snapshot_throws) {
+  auto Image = StateSnapshot::serialize(createSettings());
+  ASSERT_THROW(StateSnapshot::deserialize(Image.data(), Image.size() - 1),
+               std::runtime_error);
+}
+
+TEST(StateSnapshotTest, data_without_magic_throws) {
+  std::string Data = "{\"streams\": []}";
+  ASSERT_THROW(StateSnapshot::deserialize(Data.data(), Data.size()),
+               std::runtime_error);
+}
+
+TEST(StateSnapshotTest, file_round_trip_restores_streams) {
+  std::string Filename = "StateSnapshotTest.snapshot";
+  ASSERT_TRUE(StateSnapshot::writeFile(
+      Filename, StateSnapshot::serialize(createSettings())));
+  auto Streams = StateSnapshot::readFile(Filename);
+  std::remove(Filename.c_str());
+  ASSERT_EQ(2u, Streams.size());
+  ASSERT_EQ("SIMPLE:DOUBLE", Streams.at(0).Name);
+}
+
+TEST(StateSnapshotTest, missing_file_restores_nothing) {
+  ASSERT_TRUE(StateSnapshot::readFile("does_not_exist.snapshot").empty());
+}
@@ -1,5 +1,6 @@
 #pragma once
 #include "../Stream.h"
+#include <atomic>
 
 class FakeEpicsClient : public Forwarder::EpicsClient::EpicsClientInterface {
 public:
@@ -19,6 +20,39 @@ private:
   int status_{0};
 };
 
+/// A conversion path which neither converts nor sends the updates.
+class FakeConversionPath : public Forwarder::ConversionPath {
+public:
+  explicit FakeConversionPath(std::string Topic, std::string Schema = "f142",
+                              std::atomic<uint64_t> *Counter = nullptr)
+      : ConversionPath(nullptr, std::unique_ptr<Forwarder::KafkaOutput>()),
+        TopicName(std::move(Topic)), SchemaName(std::move(Schema)),
+        Counter(Counter) {}
+  int emit(std::shared_ptr<FlatBufs::EpicsPVUpdate> /* up */) override {
+    volatile uint64_t Work = 0;
+    for (uint32_t i = 0; i < WorkPerUpdate; ++i) {
+      Work = Work + i;
+    }
+    if (Counter != nullptr) {
+      ++*Counter;
+    }
+    return 0;
+  }
+  bool retryBacklog() override { return !Congested; }
+  std::string getKafkaTopicName() const override { return TopicName; }
+  std::string getSchemaName() const override { return SchemaName; }
+
+  std::string TopicName;
+  std::string SchemaName;
+  /// Counts the emitted updates if set.
+  std::atomic<uint64_t> *Counter;
+  /// Iterations of busy work per update, 500 take roughly the CPU time of a
+  /// small conversion.
+  uint32_t WorkPerUpdate{0};
+  /// Behaves as if Kafka could not take any more messages while set.
+  bool Congested{false};
+};
+
 std::shared_ptr<Forwarder::Stream> createStream(std::string ProviderType,
                                                 std::string ChannelName);
 
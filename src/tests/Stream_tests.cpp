@@ -3,27 +3,13 @@
 #include "../Forwarder.h"
 #include "../Stream.h"
 #include "../Streams.h"
+#include "../UpdateFilter.h"
 #include "../helper.h"
 #include "StreamTestUtils.h"
 #include <gmock/gmock.h>
 
 using namespace testing;
 using namespace Forwarder;
-using namespace moodycamel;
-
-/// A fake conversion path for use in testing.
-class FakeConversionPath : public ConversionPath {
-public:
-  std::string TopicName;
-  std::string SchemaName;
-
-  FakeConversionPath(std::string Topic, std::string Schema)
-      : ConversionPath(nullptr, nullptr), TopicName(std::move(Topic)),
-        SchemaName(std::move(Schema)) {}
-
-  std::string getKafkaTopicName() const override { return TopicName; }
-  std::string getSchemaName() const override { return SchemaName; }
-};
 
 /// Create a stream of random values.
 ///
@@ -59,10 +45,9 @@ std::shared_ptr<Stream> createStreamWithEntries(size_t Conversions,
 /// teardown starts.
 ///
 /// \param queue
-void clearQueue(ConcurrentQueue<std::unique_ptr<ConversionWorkPacket>> &queue) {
-  std::unique_ptr<ConversionWorkPacket> Data;
-  while (queue.try_dequeue(Data)) {
-    Data.reset();
+void clearQueue(ConversionWorkQueue &queue) {
+  while (auto Data = queue.pop()) {
+    queue.release(Data);
   }
 }
 
@@ -121,7 +106,7 @@ TEST(StreamTest, add_conversion_path_twice_is_not_okay) {
 
 TEST(StreamTest, filling_queue_from_empty_stream_gives_no_data) {
   auto Stream = createStreamRandom("provider", "channel1");
-  ConcurrentQueue<std::unique_ptr<ConversionWorkPacket>> queue;
+  ConversionWorkQueue queue;
   auto NumEnqueued = Stream->fillConversionQueue(queue, 10);
   ASSERT_EQ(NumEnqueued, 0u);
 }
@@ -129,7 +114,7 @@ TEST(StreamTest, filling_queue_from_empty_stream_gives_no_data) {
 TEST(StreamTest, filling_queue_from_stream_gives_data) {
   size_t NumEntries = 2;
   auto Stream = createStreamWithEntries(1, NumEntries);
-  ConcurrentQueue<std::unique_ptr<ConversionWorkPacket>> queue;
+  ConversionWorkQueue queue;
   auto NumEnqueued = Stream->fillConversionQueue(queue, 10);
   ASSERT_EQ(NumEnqueued, NumEntries);
 
@@ -141,7 +126,7 @@ TEST(StreamTest, filling_queue_when_multiple_conversion_paths_gives_data) {
   size_t NumEntries = 2;
   size_t NumConversions = 2;
   auto Stream = createStreamWithEntries(NumConversions, NumEntries);
-  ConcurrentQueue<std::unique_ptr<ConversionWorkPacket>> queue;
+  ConversionWorkQueue queue;
   auto NumEnqueued = Stream->fillConversionQueue(queue, 10);
   ASSERT_EQ(NumEnqueued, NumConversions * NumEntries);
 
@@ -153,7 +138,7 @@ TEST(
     StreamTest,
     filling_queue_when_max_buffer_less_than_data_in_stream_gives_correct_amount) {
   auto Stream = createStreamWithEntries(1, 10);
-  ConcurrentQueue<std::unique_ptr<ConversionWorkPacket>> queue;
+  ConversionWorkQueue queue;
 
   uint32_t Max = 5;
   auto NumEnqueued = Stream->fillConversionQueue(queue, Max);
@@ -166,7 +151,7 @@ TEST(
 TEST(StreamTest,
      filling_queue_when_max_buffer_less_than_number_conversions_gives_no_data) {
   auto Stream = createStreamWithEntries(10, 10);
-  ConcurrentQueue<std::unique_ptr<ConversionWorkPacket>> queue;
+  ConversionWorkQueue queue;
 
   uint32_t Max = 5;
   auto NumEnqueued = Stream->fillConversionQueue(queue, Max);
@@ -178,7 +163,7 @@ TEST(StreamTest,
 
 TEST(StreamTest, filling_queue_when_no_conversions_gives_no_data) {
   auto Stream = createStreamWithEntries(0, 5);
-  ConcurrentQueue<std::unique_ptr<ConversionWorkPacket>> queue;
+  ConversionWorkQueue queue;
 
   auto NumEnqueued = Stream->fillConversionQueue(queue, 10);
   ASSERT_EQ(NumEnqueued, 0u);
@@ -186,3 +171,56 @@ TEST(StreamTest, filling_queue_when_no_conversions_gives_no_data) {
   // Post test clean up.
   clearQueue(queue);
 }
+
+TEST(StreamTest, updates_emitted_again_from_cache_bypass_the_filter) {
+  auto Queue = std::make_shared<PVUpdateQueue>();
+  ChannelInfo Info{"provider", "channel"};
+  auto TestStream = std::make_shared<Stream>(
+      Info, std::make_shared<FakeEpicsClient>(), Queue);
+  TestStream->addConverter(
+      ::make_unique<FakeConversionPath>("Topic", "Schema"));
+  FilterSettings Settings;
+  Settings.MinIntervalMS = 1000;
+  TestStream->setFilter(UpdateFilter::create(Settings));
+
+  auto Update = std::make_shared<FlatBufs::EpicsPVUpdate>();
+  Update->ts_epics_monitor = 1;
+  auto Cached = std::make_shared<FlatBufs::EpicsPVUpdate>(*Update);
+  Cached->cached_reemit = true;
+  auto Repeated = std::make_shared<FlatBufs::EpicsPVUpdate>(*Update);
+  Queue->enqueue(Update);
+  Queue->enqueue(Cached);
+  Queue->enqueue(Repeated);
+
+  ConversionWorkQueue WorkQueue;
+  // The repeated monitor update is within the minimum interval
+  ASSERT_EQ(TestStream->fillConversionQueue(WorkQueue, 10), 2u);
+  auto First = WorkQueue.pop();
+  ASSERT_EQ(First->up, Update);
+  WorkQueue.release(First);
+  auto Second = WorkQueue.pop();
+  ASSERT_EQ(Second->up, Cached);
+  WorkQueue.release(Second);
+  ASSERT_EQ(WorkQueue.pop(), nullptr);
+}
+
+TEST(StreamTest, updates_stay_queued_while_kafka_is_congested) {
+  auto Queue = std::make_shared<PVUpdateQueue>();
+  auto TestStream = std::make_shared<Stream>(
+      ChannelInfo{"provider", "channel"}, std::make_shared<FakeEpicsClient>(),
+      Queue);
+  auto Path = ::make_unique<FakeConversionPath>("Topic", "Schema");
+  Path->Congested = true;
+  auto PathPtr = Path.get();
+  TestStream->addConverter(std::move(Path));
+  for (size_t i = 0; i < 10; ++i) {
+    Queue->enqueue(std::make_shared<FlatBufs::EpicsPVUpdate>());
+  }
+  ConversionWorkQueue WorkQueue;
+  ASSERT_EQ(TestStream->fillConversionQueue(WorkQueue, 1024), 0u);
+  ASSERT_EQ(Queue->sizeApprox(), 10u);
+
+  PathPtr->Congested = false;
+  ASSERT_EQ(TestStream->fillConversionQueue(WorkQueue, 1024), 10u);
+  clearQueue(WorkQueue);
+}
@@ -180,3 +180,52 @@ TEST(StreamsTest, get_stream_by_name_does_not_return_stream_when_not_found) {
   auto answer = streams.getStreamByChannelName("incorrect_name");
   ASSERT_EQ(answer, nullptr);
 }
+
+TEST(StreamsTest, get_stream_by_name_does_not_return_stopped_stream) {
+  Streams streams;
+  for (int i = 0; i < 100; ++i) {
+    streams.add(createStream("some_type", "stream" + std::to_string(i)));
+  }
+  streams.stopChannel("stream42");
+  ASSERT_EQ(streams.getStreamByChannelName("stream42"), nullptr);
+  ASSERT_EQ(streams.getStreamByChannelName("stream43")
+                ->getChannelInfo()
+                .channel_name,
+            "stream43");
+  ASSERT_EQ(streams.size(), 99u);
+}
+
+TEST(StreamsTest, get_stream_by_name_finds_the_first_added_stream) {
+  Streams streams;
+  auto s1 = createStream("some_type", "stream");
+  streams.add(s1);
+  streams.add(createStream("other_type", "stream"));
+  ASSERT_EQ(streams.getStreamByChannelName("stream"), s1);
+}
+
+TEST(StreamsTest, stopped_stream_is_destroyed_once_no_longer_used) {
+  Streams streams;
+  auto s1 = createStream("some_type", "stream");
+  std::weak_ptr<Stream> Weak = s1;
+  streams.add(s1);
+  streams.stopChannel("stream");
+  ASSERT_EQ(streams.reclaimRetired(std::chrono::milliseconds(0)), 1u);
+  ASSERT_FALSE(Weak.expired());
+  s1.reset();
+  ASSERT_EQ(streams.reclaimRetired(std::chrono::milliseconds(0)), 0u);
+  ASSERT_TRUE(Weak.expired());
+}
+
+TEST(StreamsTest, cleared_streams_wait_for_the_grace_period) {
+  Streams streams;
+  auto s1 = createStream("hello", "world");
+  std::weak_ptr<Stream> Weak = s1;
+  streams.add(std::move(s1));
+  streams.add(createStream("world", "hello"));
+  streams.clearStreams();
+  ASSERT_EQ(streams.size(), 0u);
+  ASSERT_EQ(streams.reclaimRetired(std::chrono::hours(1)), 2u);
+  ASSERT_FALSE(Weak.expired());
+  ASSERT_EQ(streams.reclaimRetired(std::chrono::milliseconds(0)), 0u);
+  ASSERT_TRUE(Weak.expired());
+}
@@ -0,0 +1,52 @@
+#include "../UpdateFilter.h"
+#include <gtest/gtest.h>
+
+using namespace Forwarder;
+
+/// Creates an update with a double value field.
+static FlatBufs::EpicsPVUpdate createUpdate(double Value, uint64_t TimeMS) {
+  auto FieldBuilder = epics::pvData::getFieldCreate()->createFieldBuilder();
+  FieldBuilder->add("value", epics::pvData::pvDouble);
+  auto PVStructure = epics::pvData::getPVDataCreate()->createPVStructure(
+      FieldBuilder->createStructure());
+  PVStructure->getSubField<epics::pvData::PVDouble>("value")->put(Value);
+  FlatBufs::EpicsPVUpdate Update;
+  Update.epics_pvstr = PVStructure;
+  Update.ts_epics_monitor = TimeMS * 1000000;
+  return Update;
+}
+
+TEST(UpdateFilterTest, no_filter_is_created_for_default_settings) {
+  ASSERT_EQ(UpdateFilter::create(FilterSettings()), nullptr);
+}
+
+TEST(UpdateFilterTest, absolute_deadband_drops_small_changes) {
+  FilterSettings Settings;
+  Settings.DeadbandAbsolute = 0.5;
+  auto Filter = UpdateFilter::create(Settings);
+  ASSERT_NE(Filter, nullptr);
+  ASSERT_TRUE(Filter->accept(createUpdate(1.0, 0)));
+  ASSERT_FALSE(Filter->accept(createUpdate(1.4, 1)));
+  ASSERT_FALSE(Filter->accept(createUpdate(0.6, 2)));
+  ASSERT_TRUE(Filter->accept(createUpdate(1.6, 3)));
+  // Compared against the last forwarded value
+  ASSERT_FALSE(Filter->accept(createUpdate(2.0, 4)));
+}
+
+TEST(UpdateFilterTest, relative_deadband_drops_small_changes) {
+  FilterSettings Settings;
+  Settings.DeadbandRelative = 0.1;
+  auto Filter = UpdateFilter::create(Settings);
+  ASSERT_TRUE(Filter->accept(createUpdate(100.0, 0)));
+  ASSERT_FALSE(Filter->accept(createUpdate(109.0, 1)));
+  ASSERT_TRUE(Filter->accept(createUpdate(111.0, 2)));
+}
+
+TEST(UpdateFilterTest, min_interval_drops_updates_in_quick_succession) {
+  FilterSettings Settings;
+  Settings.MinIntervalMS = 10;
+  auto Filter = UpdateFilter::create(Settings);
+  ASSERT_TRUE(Filter->accept(createUpdate(1.0, 100)));
+  ASSERT_FALSE(Filter->accept(createUpdate(2.0, 105)));
+  ASSERT_TRUE(Filter->accept(createUpdate(3.0, 110)));
+}
@@ -0,0 +1,64 @@
+#include "PVUpdateQueue.h"
+#include "WorkSignal.h"
+#include <gtest/gtest.h>
+#include <thread>
+
+using namespace Forwarder;
+
+TEST(WorkSignalTest, wait_times_out_without_notification) {
+  WorkSignal Signal;
+  auto Ticket = Signal.prepareWait();
+  ASSERT_FALSE(Signal.wait(Ticket, std::chrono::milliseconds(10)));
+}
+
+TEST(WorkSignalTest, notification_before_wait_is_not_lost) {
+  WorkSignal Signal;
+  auto Ticket = Signal.prepareWait();
+  Signal.notify();
+  // Would time out if the notification got lost
+  ASSERT_TRUE(Signal.wait(Ticket, std::chrono::seconds(10)));
+}
+
+TEST(WorkSignalTest, parked_waiter_is_woken_up_by_notification) {
+  WorkSignal Signal;
+  auto Ticket = Signal.prepareWait();
+  std::thread Notifier([&Signal] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    Signal.notify();
+  });
+  auto Start = std::chrono::steady_clock::now();
+  ASSERT_TRUE(Signal.wait(Ticket, std::chrono::seconds(10)));
+  ASSERT_LT(std::chrono::steady_clock::now() - Start, std::chrono::seconds(5));
+  Notifier.join();
+}
+
+TEST(WorkSignalTest, notify_all_wakes_up_all_parked_waiters) {
+  WorkSignal Signal;
+  auto Ticket = Signal.prepareWait();
+  std::atomic<int> NumWoken{0};
+  std::vector<std::thread> Waiters;
+  for (int i = 0; i < 4; ++i) {
+    Waiters.emplace_back([&Signal, &NumWoken, Ticket] {
+      if (Signal.wait(Ticket, std::chrono::seconds(10))) {
+        ++NumWoken;
+      }
+    });
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  Signal.notifyAll();
+  for (auto &Waiter : Waiters) {
+    Waiter.join();
+  }
+  ASSERT_EQ(NumWoken, 4);
+}
+
+TEST(WorkSignalTest, enqueue_on_pv_update_queue_notifies_signal) {
+  auto Signal = std::make_shared<WorkSignal>();
+  PVUpdateQueue Queue(Signal);
+  auto Ticket = Signal->prepareWait();
+  ASSERT_TRUE(Queue.enqueue(std::make_shared<FlatBufs::EpicsPVUpdate>()));
+  ASSERT_NE(Signal->prepareWait(), Ticket);
+  std::shared_ptr<FlatBufs::EpicsPVUpdate> Update;
+  ASSERT_TRUE(Queue.tryDequeue(Update));
+  ASSERT_NE(Update, nullptr);
+}
@@ -0,0 +1,53 @@
+#include "../EpicsClient/ZeroCopyBudget.h"
+#include <gtest/gtest.h>
+
+using namespace Forwarder::EpicsClient;
+
+TEST(ZeroCopyBudgetTest, element_is_released_with_the_last_reference) {
+  ZeroCopyBudget Budget(2);
+  auto Element = std::make_shared<int>(42);
+  int NumReleased = 0;
+  auto Shared = Budget.share(Element, [&NumReleased]() { ++NumReleased; });
+  ASSERT_NE(Shared, nullptr);
+  ASSERT_EQ(*Shared, 42);
+  ASSERT_EQ(Budget.getNumShared(), 1u);
+  // Like the cached update and the update in the stream queue
+  auto Cached = Shared;
+  auto Queued = Shared;
+  Shared.reset();
+  Cached.reset();
+  ASSERT_EQ(NumReleased, 0);
+  Queued.reset();
+  ASSERT_EQ(NumReleased, 1);
+  ASSERT_EQ(Budget.getNumShared(), 0u);
+}
+
+TEST(ZeroCopyBudgetTest, elements_have_to_be_copied_once_budget_is_used_up) {
+  ZeroCopyBudget Budget(2);
+  auto Element = std::make_shared<int>(1);
+  int NumReleased = 0;
+  auto Release = [&NumReleased]() { ++NumReleased; };
+  auto First = Budget.share(Element, Release);
+  auto Second = Budget.share(Element, Release);
+  ASSERT_NE(First, nullptr);
+  ASSERT_NE(Second, nullptr);
+  ASSERT_EQ(Budget.share(Element, Release), nullptr);
+  ASSERT_EQ(Budget.getNumShared(), 2u);
+  First.reset();
+  ASSERT_EQ(NumReleased, 1);
+  auto Third = Budget.share(Element, Release);
+  ASSERT_NE(Third, nullptr);
+  ASSERT_EQ(NumReleased, 1);
+}
+
+TEST(ZeroCopyBudgetTest, element_outliving_the_budget_is_released) {
+  int NumReleased = 0;
+  std::shared_ptr<int> Shared;
+  {
+    ZeroCopyBudget Budget(1);
+    Shared = Budget.share(std::make_shared<int>(1),
+                          [&NumReleased]() { ++NumReleased; });
+  }
+  Shared.reset();
+  ASSERT_EQ(NumReleased, 1);
+}
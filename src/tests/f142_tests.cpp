@@ -0,0 +1,194 @@
+#include "../EpicsPVUpdate.h"
+#include "../SchemaRegistry.h"
+#include "schemas/f142_logdata_generated.h"
+#include <gtest/gtest.h>
+#include <pv/pvData.h>
+
+using namespace FlatBufs;
+
+static std::unique_ptr<FlatBufferCreator> createF142Converter() {
+  return SchemaRegistry::items().at("f142")->createConverter();
+}
+
+/// Creates an update with a scalar value field of the given type.
+static EpicsPVUpdate createScalarUpdate(epics::pvData::ScalarType Type,
+                                        double Value) {
+  auto FieldBuilder = epics::pvData::getFieldCreate()->createFieldBuilder();
+  FieldBuilder->add("value", Type);
+  auto PVStructure = epics::pvData::getPVDataCreate()->createPVStructure(
+      FieldBuilder->createStructure());
+  PVStructure->getSubField<epics::pvData::PVScalar>("value")->putFrom(Value);
+  EpicsPVUpdate Update;
+  Update.channel = "channel";
+  Update.epics_pvstr = PVStructure;
+  return Update;
+}
+
+/// Creates an update whose value field is a variant union.
+static EpicsPVUpdate createUnionUpdate(epics::pvData::PVFieldPtr Selected) {
+  auto FieldBuilder = epics::pvData::getFieldCreate()->createFieldBuilder();
+  FieldBuilder->add("value",
+                    epics::pvData::getFieldCreate()->createVariantUnion());
+  auto PVStructure = epics::pvData::getPVDataCreate()->createPVStructure(
+      FieldBuilder->createStructure());
+  PVStructure->getSubField<epics::pvData::PVUnion>("value")->set(Selected);
+  EpicsPVUpdate Update;
+  Update.channel = "channel";
+  Update.epics_pvstr = PVStructure;
+  return Update;
+}
+
+TEST(F142ConverterTest, alternating_structures_keep_their_value_type) {
+  auto Converter = createF142Converter();
+  auto DoubleUpdate = createScalarUpdate(epics::pvData::pvDouble, 1.5);
+  auto IntUpdate = createScalarUpdate(epics::pvData::pvInt, 7);
+  for (int i = 0; i < 3; ++i) {
+    auto Message = Converter->create(DoubleUpdate);
+    auto LogData = GetLogData(Message->message().data);
+    ASSERT_EQ(LogData->value_type(), Value::Double);
+    ASSERT_EQ(LogData->value_as_Double()->value(), 1.5);
+    Message = Converter->create(IntUpdate);
+    LogData = GetLogData(Message->message().data);
+    ASSERT_EQ(LogData->value_type(), Value::Int);
+    ASSERT_EQ(LogData->value_as_Int()->value(), 7);
+  }
+}
+
+#if HAVE_F142_ARRAY_STRING
+TEST(F142ConverterTest, string_array_is_encoded) {
+  auto FieldBuilder = epics::pvData::getFieldCreate()->createFieldBuilder();
+  FieldBuilder->addArray("value", epics::pvData::pvString);
+  auto PVStructure = epics::pvData::getPVDataCreate()->createPVStructure(
+      FieldBuilder->createStructure());
+  epics::pvData::PVStringArray::svector Strings;
+  Strings.push_back("first");
+  Strings.push_back("");
+  Strings.push_back("third");
+  PVStructure->getSubField<epics::pvData::PVStringArray>("value")->replace(
+      epics::pvData::freeze(Strings));
+  EpicsPVUpdate Update;
+  Update.channel = "channel";
+  Update.epics_pvstr = PVStructure;
+
+  auto Converter = createF142Converter();
+  auto Message = Converter->create(Update);
+  auto LogData = GetLogData(Message->message().data);
+  ASSERT_EQ(LogData->value_type(), Value::ArrayString);
+  auto Values = LogData->value_as_ArrayString()->value();
+  ASSERT_EQ(Values->size(), 3u);
+  ASSERT_EQ(Values->Get(0)->str(), "first");
+  ASSERT_EQ(Values->Get(1)->str(), "");
+  ASSERT_EQ(Values->Get(2)->str(), "third");
+}
+#endif
+
+TEST(F142ConverterTest, selected_union_member_is_encoded) {
+  auto Selected =
+      epics::pvData::getPVDataCreate()->createPVScalar(epics::pvData::pvDouble);
+  std::static_pointer_cast<epics::pvData::PVDouble>(Selected)->put(2.5);
+  auto Update = createUnionUpdate(Selected);
+
+  auto Converter = createF142Converter();
+  auto Message = Converter->create(Update);
+  auto LogData = GetLogData(Message->message().data);
+  ASSERT_EQ(LogData->value_type(), Value::Double);
+  ASSERT_EQ(LogData->value_as_Double()->value(), 2.5);
+  ASSERT_EQ(Converter->getStats()["err_not_implemented_yet"], 0);
+}
+
+TEST(F142ConverterTest, unsupported_union_member_is_counted) {
+  auto MemberBuilder = epics::pvData::getFieldCreate()->createFieldBuilder();
+  MemberBuilder->add("index", epics::pvData::pvInt);
+  auto Selected = epics::pvData::getPVDataCreate()->createPVStructure(
+      MemberBuilder->createStructure());
+  auto Update = createUnionUpdate(Selected);
+
+  auto Converter = createF142Converter();
+  auto Message = Converter->create(Update);
+  auto LogData = GetLogData(Message->message().data);
+  ASSERT_EQ(LogData->value_type(), Value::NONE);
+  ASSERT_EQ(Converter->getStats()["err_not_implemented_yet"], 1);
+}
+
+#if HAVE_F142_ALARM
+/// Creates an update with a double value and an alarm.
+static EpicsPVUpdate createAlarmUpdate(std::string const &Channel,
+                                       int32_t Severity,
+                                       std::string const &Message) {
+  auto FieldBuilder = epics::pvData::getFieldCreate()->createFieldBuilder();
+  FieldBuilder->add("value", epics::pvData::pvDouble)
+      ->addNestedStructure("alarm")
+      ->add("severity", epics::pvData::pvInt)
+      ->add("status", epics::pvData::pvInt)
+      ->add("message", epics::pvData::pvString)
+      ->endNested();
+  auto PVStructure = epics::pvData::getPVDataCreate()->createPVStructure(
+      FieldBuilder->createStructure());
+  PVStructure->getSubField<epics::pvData::PVInt>("alarm.severity")
+      ->put(Severity);
+  PVStructure->getSubField<epics::pvData::PVString>("alarm.message")
+      ->put(Message);
+  EpicsPVUpdate Update;
+  Update.channel = Channel;
+  Update.epics_pvstr = PVStructure;
+  return Update;
+}
+
+TEST(F142ConverterTest, alarm_is_encoded) {
+  auto Converter = createF142Converter();
+  auto Message = Converter->create(createAlarmUpdate("channel", 2, "HIHI"));
+  auto LogData = GetLogData(Message->message().data);
+  ASSERT_EQ(LogData->severity(), AlarmSeverity::MAJOR);
+  ASSERT_EQ(LogData->status(), AlarmStatus::HIHI);
+
+  Message = Converter->create(createAlarmUpdate("channel", 0, ""));
+  LogData = GetLogData(Message->message().data);
+  ASSERT_EQ(LogData->severity(), AlarmSeverity::NO_ALARM);
+  ASSERT_EQ(LogData->status(), AlarmStatus::NO_ALARM);
+}
+
+TEST(F142ConverterTest, alarm_on_change_is_tracked_per_channel) {
+  auto Converter = createF142Converter();
+  Converter->config({{"alarm", "on_change"}});
+  auto Message = Converter->create(createAlarmUpdate("first", 1, "HIGH"));
+  auto LogData = GetLogData(Message->message().data);
+  ASSERT_EQ(LogData->severity(), AlarmSeverity::MINOR);
+  ASSERT_EQ(LogData->status(), AlarmStatus::HIGH);
+
+  // Same alarm on another channel of the shared converter
+  Message = Converter->create(createAlarmUpdate("second", 1, "HIGH"));
+  LogData = GetLogData(Message->message().data);
+  ASSERT_EQ(LogData->severity(), AlarmSeverity::MINOR);
+  ASSERT_EQ(LogData->status(), AlarmStatus::HIGH);
+
+  Message = Converter->create(createAlarmUpdate("first", 1, "HIGH"));
+  LogData = GetLogData(Message->message().data);
+  ASSERT_EQ(LogData->severity(), AlarmSeverity::NO_CHANGE);
+  ASSERT_EQ(LogData->status(), AlarmStatus::NO_CHANGE);
+
+  Message = Converter->create(createAlarmUpdate("first", 2, "HIHI"));
+  LogData = GetLogData(Message->message().data);
+  ASSERT_EQ(LogData->severity(), AlarmSeverity::MAJOR);
+  ASSERT_EQ(LogData->status(), AlarmStatus::HIHI);
+}
+
+TEST(F142ConverterTest, alarm_only_is_sent_when_severity_changes) {
+  auto Converter = createF142Converter();
+  Converter->config({{"alarm", "only"}});
+  auto Message = Converter->create(createAlarmUpdate("channel", 1, "HIGH"));
+  ASSERT_NE(Message, nullptr);
+  auto LogData = GetLogData(Message->message().data);
+  ASSERT_EQ(LogData->value_type(), Value::NONE);
+  ASSERT_EQ(LogData->severity(), AlarmSeverity::MINOR);
+  ASSERT_EQ(LogData->status(), AlarmStatus::HIGH);
+
+  // Same severity, only the status changed
+  ASSERT_EQ(Converter->create(createAlarmUpdate("channel", 1, "LOW")), nullptr);
+
+  Message = Converter->create(createAlarmUpdate("channel", 0, ""));
+  ASSERT_NE(Message, nullptr);
+  LogData = GetLogData(Message->message().data);
+  ASSERT_EQ(LogData->severity(), AlarmSeverity::NO_ALARM);
+  ASSERT_EQ(LogData->status(), AlarmStatus::NO_ALARM);
+}
+#endif